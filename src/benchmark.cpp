@@ -0,0 +1,182 @@
+#include "benchmark.h"
+#include "grid_mandelbrot_calculator.h"
+#include "headless_gl_context.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <iostream>
+
+namespace
+{
+    struct Result
+    {
+        std::string view;
+        std::string engine;
+        int grid;
+        int maxIter;
+        double minMs, medianMs, p95Ms;
+        double mpixelsPerSecond;
+        double iterationsPerSecond;
+        CalculatorStats stats; // Of the last run
+    };
+
+    // Nearest rank percentile of sorted times
+    double percentile(const std::vector<double> &sorted, double p)
+    {
+        int rank = static_cast<int>(std::ceil(p * sorted.size()));
+        return sorted[std::clamp(rank - 1, 0, static_cast<int>(sorted.size()) - 1)];
+    }
+}
+
+const std::vector<Benchmark::View> &Benchmark::views()
+{
+    static const std::vector<View> list = {
+        {"full", -0.5, 0.0, 3.0},
+        {"seahorse", -0.7436438870371587, 0.1318259042053119, 1e-5},
+        // Its pixels escape after 2500 to 4000 iterations: with the
+        // default limit the frame would be all interior
+        {"deep", -0.743643887037158704752191506114774, 0.131825904205311970493132056385139, 1e-13, 4096},
+        {"interior", -0.1, 0.1, 0.05}};
+    return list;
+}
+
+bool Benchmark::run(const Options &options)
+{
+    static const char *engineNames[] = {"border", "bsimd", "standard", "simd", "gpuf", "gpud", "gpuff", "gpuc", "hybrid", "perturb", "psimd"};
+
+    std::vector<std::string> engines(std::begin(engineNames), std::end(engineNames));
+    GridMandelbrotCalculator::EngineType engineType;
+    if (!options.engine.empty())
+    {
+        if (!GridMandelbrotCalculator::parseEngineType(options.engine, engineType))
+        {
+            std::cerr << "Unknown engine type: " << options.engine << std::endl;
+            return false;
+        }
+        engines = {options.engine};
+    }
+
+    // The GPU engines are skipped (not failed) when there is no GL
+    HeadlessGLContext glContext;
+    bool haveGL = false;
+    bool wantGL = std::any_of(engines.begin(), engines.end(), [](const std::string &name)
+                              {
+        GridMandelbrotCalculator::EngineType type;
+        GridMandelbrotCalculator::parseEngineType(name, type);
+        return GridMandelbrotCalculator::isGpuEngine(type); });
+    if (wantGL)
+    {
+        haveGL = glContext.create();
+        if (!haveGL)
+            std::cerr << "Skipping the GPU engines" << std::endl;
+    }
+
+    const int runs = std::max(1, options.runs);
+    const double pixels = static_cast<double>(options.width) * options.height;
+    std::vector<Result> results;
+
+    for (const View &view : views())
+    {
+        int maxIter = options.maxIter > 0 ? options.maxIter : view.maxIter;
+
+        for (const std::string &engine : engines)
+        {
+            GridMandelbrotCalculator::parseEngineType(engine, engineType);
+            if (GridMandelbrotCalculator::isGpuEngine(engineType) && !haveGL)
+                continue;
+
+            for (int grid : {1, 4})
+            {
+                // Same setup as the app: 1x1 is the normal mode, the grid
+                // is computed in parallel (speed mode)
+                GridMandelbrotCalculator calculator(options.width, options.height, grid, grid);
+                calculator.setSpeedMode(grid > 1);
+                calculator.setInteriorCheck(options.interiorCheck);
+                calculator.setEngineType(engineType);
+                calculator.setMaxIterations(maxIter);
+                calculator.updateBounds(view.cre, view.cim, view.diam);
+
+                // One warm-up run (shader compilation, tile cost estimates)
+                std::vector<double> times;
+                double iterations = 0.0;
+                for (int run = 0; run <= runs; ++run)
+                {
+                    auto startTime = std::chrono::high_resolution_clock::now();
+                    calculator.compute(nullptr);
+                    const auto &data = calculator.getData(); // GPU: includes the read back
+                    auto endTime = std::chrono::high_resolution_clock::now();
+
+                    if (run == 0)
+                    {
+                        // Escape iterations of all pixels: the work of a plain
+                        // escape time loop, whatever the engine actually skips
+                        for (IterationCount count : data)
+                            iterations += count;
+                        continue;
+                    }
+                    times.push_back(std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count() / 1000.0);
+                }
+
+                std::sort(times.begin(), times.end());
+                Result result;
+                result.view = view.name;
+                result.engine = engine;
+                result.grid = grid;
+                result.maxIter = calculator.getMaxIterations();
+                result.minMs = times.front();
+                result.medianMs = percentile(times, 0.5);
+                result.p95Ms = percentile(times, 0.95);
+                result.mpixelsPerSecond = pixels / (result.medianMs * 1000.0);
+                result.iterationsPerSecond = iterations / (result.medianMs / 1000.0);
+                result.stats = calculator.getStats();
+                results.push_back(result);
+
+                if (options.verbose)
+                    std::cerr << std::format("{:<9} {:<9} {}x{} {:>10.1f} ms\n", view.name, engine, grid, grid, result.medianMs);
+            }
+        }
+    }
+
+    if (results.empty())
+    {
+        std::cerr << "No engine could be benchmarked" << std::endl;
+        return false;
+    }
+
+    if (options.json)
+    {
+        std::cout << "[\n";
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const Result &r = results[i];
+            const CalculatorStats &s = r.stats;
+            std::cout << std::format("  {{\"view\": \"{}\", \"engine\": \"{}\", \"grid\": {}, \"width\": {}, \"height\": {}, \"max_iter\": {}, \"runs\": {}, "
+                                     "\"min_ms\": {:.3f}, \"median_ms\": {:.3f}, \"p95_ms\": {:.3f}, \"mpixel_per_s\": {:.3f}, \"iterations_per_s\": {:.4e}, "
+                                     "\"pixels_iterated\": {}, \"pixels_filled\": {}, \"interior_pixels\": {}, \"peak_queue\": {}, "
+                                     "\"idle_ms\": {:.3f}, \"gpu_draw_ms\": {:.3f}, \"gpu_readback_ms\": {:.3f}}}{}\n",
+                                     r.view, r.engine, r.grid, options.width, options.height, r.maxIter, runs,
+                                     r.minMs, r.medianMs, r.p95Ms, r.mpixelsPerSecond, r.iterationsPerSecond,
+                                     s.pixelsIterated, s.pixelsFilled, s.interiorPixels, s.peakQueue,
+                                     s.idleMs, s.gpuDrawMs, s.gpuReadbackMs,
+                                     i + 1 < results.size() ? "," : "");
+        }
+        std::cout << "]" << std::endl;
+    }
+    else
+    {
+        std::cout << "view,engine,grid,width,height,max_iter,runs,min_ms,median_ms,p95_ms,mpixel_per_s,iterations_per_s,"
+                     "pixels_iterated,pixels_filled,interior_pixels,peak_queue,idle_ms,gpu_draw_ms,gpu_readback_ms\n";
+        for (const Result &r : results)
+        {
+            const CalculatorStats &s = r.stats;
+            std::cout << std::format("{},{},{},{},{},{},{},{:.3f},{:.3f},{:.3f},{:.3f},{:.4e},{},{},{},{},{:.3f},{:.3f},{:.3f}\n",
+                                     r.view, r.engine, r.grid, options.width, options.height, r.maxIter, runs,
+                                     r.minMs, r.medianMs, r.p95Ms, r.mpixelsPerSecond, r.iterationsPerSecond,
+                                     s.pixelsIterated, s.pixelsFilled, s.interiorPixels, s.peakQueue,
+                                     s.idleMs, s.gpuDrawMs, s.gpuReadbackMs);
+        }
+        std::cout.flush();
+    }
+    return true;
+}
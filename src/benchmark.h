@@ -0,0 +1,38 @@
+#pragma once
+
+#include "mandelbrot_calculator.h"
+#include <string>
+#include <vector>
+
+// Reproducible engine benchmark: a fixed set of named views computed by
+// every engine, with and without the 4x4 grid, without a window.
+// Reports the min/median/p95 compute time of each combination, with the
+// pixel and iteration rates of the median run, as CSV or JSON on stdout.
+class Benchmark
+{
+public:
+    struct Options
+    {
+        int runs = 5; // Timed runs per combination (after one warm-up run)
+        int width = 800;
+        int height = 600;
+        int maxIter = 0;           // 0: limit of each view
+        std::string engine;        // Empty: all engines
+        bool json = false;         // JSON instead of CSV
+        bool interiorCheck = true;
+        bool verbose = false;      // Progress on std::cerr
+    };
+
+    struct View
+    {
+        const char *name;
+        double cre, cim, diam;
+        int maxIter = MandelbrotCalculator::MAX_ITER;
+    };
+
+    // The benchmark views (full set, seahorse valley, deep boundary, interior)
+    static const std::vector<View> &views();
+
+    // Returns false when nothing could be measured
+    static bool run(const Options &options);
+};
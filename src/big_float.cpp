@@ -0,0 +1,301 @@
+#include "big_float.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+
+BigFloat::BigFloat(double value, int fracLimbs)
+{
+    fracLimbs = std::max(1, fracLimbs);
+    limbs.assign(fracLimbs + 1, 0);
+    negative = value < 0.0;
+
+    // Exact: each step only shifts the remaining bits of the double
+    double v = std::min(std::fabs(value), 4294967295.0);
+    double integer = std::floor(v);
+    limbs[fracLimbs] = static_cast<uint32_t>(integer);
+    v -= integer;
+    for (int k = fracLimbs - 1; k >= 0 && v > 0.0; --k)
+    {
+        v *= 4294967296.0;
+        double limb = std::floor(v);
+        limbs[k] = static_cast<uint32_t>(limb);
+        v -= limb;
+    }
+    if (isZero())
+        negative = false;
+}
+
+int BigFloat::limbsFor(double diam)
+{
+    if (!(diam > 0.0) || !std::isfinite(diam))
+        return 2;
+    double bits = -std::log2(diam) + 64.0;
+    return std::max(2, static_cast<int>(std::ceil(bits / 32.0)));
+}
+
+bool BigFloat::parse(const std::string &text, BigFloat &value, int fracLimbs)
+{
+    // Sign, digits with an optional point, optional exponent
+    size_t i = 0;
+    bool minus = false;
+    if (i < text.size() && (text[i] == '-' || text[i] == '+'))
+        minus = text[i++] == '-';
+
+    std::string digits;
+    int pointPos = -1;
+    for (; i < text.size(); ++i)
+    {
+        char c = text[i];
+        if (std::isdigit(static_cast<unsigned char>(c)))
+            digits += c;
+        else if (c == '.' && pointPos < 0)
+            pointPos = static_cast<int>(digits.size());
+        else
+            break;
+    }
+    if (digits.empty())
+        return false;
+    if (pointPos < 0)
+        pointPos = static_cast<int>(digits.size());
+
+    if (i < text.size() && (text[i] == 'e' || text[i] == 'E'))
+    {
+        size_t end = 0;
+        int exponent;
+        try
+        {
+            exponent = std::stoi(text.substr(i + 1), &end);
+        }
+        catch (...)
+        {
+            return false;
+        }
+        if (end == 0 || exponent < -100000 || exponent > 100000)
+            return false;
+        pointPos += exponent;
+        i += 1 + end;
+    }
+    if (i != text.size())
+        return false;
+
+    // Move the point inside the digits
+    if (pointPos < 0)
+    {
+        digits.insert(0, -pointPos, '0');
+        pointPos = 0;
+    }
+    if (pointPos > static_cast<int>(digits.size()))
+        digits.append(pointPos - digits.size(), '0');
+
+    uint64_t integer = 0;
+    for (int k = 0; k < pointPos; ++k)
+    {
+        integer = integer * 10 + (digits[k] - '0');
+        if (integer > 0x7FFFFFFF)
+            return false;
+    }
+
+    int fracDigits = static_cast<int>(digits.size()) - pointPos;
+    if (fracLimbs <= 0)
+        fracLimbs = std::max(2, static_cast<int>(std::ceil(fracDigits * 3.3219280948873623 / 32.0)) + 1);
+
+    // Fraction from the last digit up: x = (d + x) / 10
+    BigFloat result(0.0, fracLimbs);
+    for (int k = static_cast<int>(digits.size()) - 1; k >= pointPos; --k)
+    {
+        result.limbs[fracLimbs] = digits[k] - '0';
+        uint64_t remainder = 0;
+        for (int l = fracLimbs; l >= 0; --l)
+        {
+            uint64_t current = (remainder << 32) | result.limbs[l];
+            result.limbs[l] = static_cast<uint32_t>(current / 10);
+            remainder = current % 10;
+        }
+    }
+    result.limbs[fracLimbs] = static_cast<uint32_t>(integer);
+    result.negative = minus && !result.isZero();
+    value = result;
+    return true;
+}
+
+double BigFloat::toDouble() const
+{
+    // The three limbs from the most significant non zero one hold more
+    // than the 53 bits of a double
+    int fracLimbs = getPrecision();
+    int top = fracLimbs;
+    while (top > 0 && limbs[top] == 0)
+        --top;
+
+    double result = 0.0;
+    for (int k = top; k >= std::max(0, top - 2); --k)
+        result += std::ldexp(static_cast<double>(limbs[k]), 32 * (k - fracLimbs));
+    return negative ? -result : result;
+}
+
+std::string BigFloat::toString(int digits) const
+{
+    int fracLimbs = getPrecision();
+    if (digits <= 0)
+        digits = static_cast<int>(fracLimbs * 32 * 0.30102999566398120);
+
+    std::string text = negative ? "-" : "";
+    text += std::to_string(limbs[fracLimbs]);
+    text += '.';
+
+    // Each digit is the carry out of the fraction times 10
+    std::vector<uint32_t> fraction(limbs.begin(), limbs.end() - 1);
+    for (int d = 0; d < digits; ++d)
+    {
+        uint64_t carry = 0;
+        for (uint32_t &limb : fraction)
+        {
+            uint64_t current = static_cast<uint64_t>(limb) * 10 + carry;
+            limb = static_cast<uint32_t>(current);
+            carry = current >> 32;
+        }
+        text += static_cast<char>('0' + carry);
+    }
+
+    // Round to nearest on the remaining fraction (parsed values lie just below
+    // their decimal text, which would otherwise print as ...999)
+    if (!fraction.empty() && (fraction.back() & 0x80000000u))
+    {
+        size_t k = text.size();
+        while (k > 0 && (text[k - 1] == '9' || text[k - 1] == '.'))
+        {
+            if (text[k - 1] == '9')
+                text[k - 1] = '0';
+            --k;
+        }
+        if (k > 0 && text[k - 1] != '-')
+            ++text[k - 1];
+        else
+            text.insert(k, "1");
+    }
+
+    while (text.back() == '0' && text[text.size() - 2] != '.')
+        text.pop_back();
+    return text;
+}
+
+BigFloat BigFloat::withPrecision(int fracLimbs) const
+{
+    fracLimbs = std::max(1, fracLimbs);
+    BigFloat result = *this;
+    int current = getPrecision();
+    if (fracLimbs > current)
+        result.limbs.insert(result.limbs.begin(), fracLimbs - current, 0);
+    else if (fracLimbs < current)
+        result.limbs.erase(result.limbs.begin(), result.limbs.begin() + (current - fracLimbs));
+    if (result.isZero())
+        result.negative = false;
+    return result;
+}
+
+bool BigFloat::isZero() const
+{
+    return std::all_of(limbs.begin(), limbs.end(), [](uint32_t limb)
+                       { return limb == 0; });
+}
+
+int BigFloat::compareMagnitude(const BigFloat &a, const BigFloat &b)
+{
+    // Same precision
+    for (int k = static_cast<int>(a.limbs.size()) - 1; k >= 0; --k)
+    {
+        if (a.limbs[k] != b.limbs[k])
+            return a.limbs[k] < b.limbs[k] ? -1 : 1;
+    }
+    return 0;
+}
+
+BigFloat BigFloat::operator-() const
+{
+    BigFloat result = *this;
+    result.negative = !negative && !isZero();
+    return result;
+}
+
+BigFloat BigFloat::addSigned(const BigFloat &a, const BigFloat &b, bool negateB)
+{
+    int fracLimbs = std::max(a.getPrecision(), b.getPrecision());
+    BigFloat x = a.withPrecision(fracLimbs);
+    BigFloat y = b.withPrecision(fracLimbs);
+    bool yNegative = y.negative != negateB;
+
+    if (x.negative == yNegative)
+    {
+        uint64_t carry = 0;
+        for (size_t k = 0; k < x.limbs.size(); ++k)
+        {
+            uint64_t sum = static_cast<uint64_t>(x.limbs[k]) + y.limbs[k] + carry;
+            x.limbs[k] = static_cast<uint32_t>(sum);
+            carry = sum >> 32;
+        }
+        return x;
+    }
+
+    // Opposite signs: the smaller magnitude from the larger one
+    bool swap = compareMagnitude(x, y) < 0;
+    const BigFloat &large = swap ? y : x;
+    const BigFloat &small = swap ? x : y;
+    BigFloat result = large;
+    result.negative = swap ? yNegative : x.negative;
+    int64_t borrow = 0;
+    for (size_t k = 0; k < result.limbs.size(); ++k)
+    {
+        int64_t difference = static_cast<int64_t>(large.limbs[k]) - small.limbs[k] - borrow;
+        borrow = difference < 0;
+        result.limbs[k] = static_cast<uint32_t>(difference + (borrow << 32));
+    }
+    if (result.isZero())
+        result.negative = false;
+    return result;
+}
+
+BigFloat operator+(const BigFloat &a, const BigFloat &b)
+{
+    return BigFloat::addSigned(a, b, false);
+}
+
+BigFloat operator-(const BigFloat &a, const BigFloat &b)
+{
+    return BigFloat::addSigned(a, b, true);
+}
+
+BigFloat operator*(const BigFloat &a, const BigFloat &b)
+{
+    int fracLimbs = std::max(a.getPrecision(), b.getPrecision());
+    BigFloat x = a.withPrecision(fracLimbs);
+    BigFloat y = b.withPrecision(fracLimbs);
+    const size_t n = x.limbs.size();
+
+    // Schoolbook product; limb t of it weighs 2^(32 * (t - 2 * fracLimbs)),
+    // so the result is limbs fracLimbs..2 * fracLimbs (truncated)
+    std::vector<uint32_t> product(2 * n, 0);
+    for (size_t i = 0; i < n; ++i)
+    {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < n; ++j)
+        {
+            uint64_t current = static_cast<uint64_t>(x.limbs[i]) * y.limbs[j] + product[i + j] + carry;
+            product[i + j] = static_cast<uint32_t>(current);
+            carry = current >> 32;
+        }
+        product[i + n] = static_cast<uint32_t>(carry);
+    }
+
+    BigFloat result = x;
+    std::copy_n(product.begin() + fracLimbs, n, result.limbs.begin());
+    result.negative = x.negative != y.negative && !result.isZero();
+    return result;
+}
+
+bool operator==(const BigFloat &a, const BigFloat &b)
+{
+    int fracLimbs = std::max(a.getPrecision(), b.getPrecision());
+    BigFloat x = a.withPrecision(fracLimbs);
+    BigFloat y = b.withPrecision(fracLimbs);
+    return x.negative == y.negative && x.limbs == y.limbs;
+}
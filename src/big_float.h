@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Signed fixed point number for deep zoom coordinates: one 32 bit integer
+// limb and any number of 32 bit fraction limbs. Plenty for the reference
+// orbit, whose values stay below 8 in magnitude until they escape.
+// Operations on numbers of different precision return the larger one.
+class BigFloat
+{
+public:
+    BigFloat() : BigFloat(0.0) {}
+    explicit BigFloat(double value, int fracLimbs = 2);
+
+    // Decimal text ("-0.743643887037158704752191506114774", "1.5e-3").
+    // fracLimbs 0: enough for the digits given. Returns false if malformed.
+    static bool parse(const std::string &text, BigFloat &value, int fracLimbs = 0);
+
+    // Fraction limbs to tell apart the pixels of a view of diameter diam
+    // (64 spare bits over the depth)
+    static int limbsFor(double diam);
+
+    double toDouble() const;
+    std::string toString(int digits = 0) const; // 0: digits of the precision
+
+    int getPrecision() const { return static_cast<int>(limbs.size()) - 1; }
+    BigFloat withPrecision(int fracLimbs) const;
+
+    BigFloat operator-() const;
+    friend BigFloat operator+(const BigFloat &a, const BigFloat &b);
+    friend BigFloat operator-(const BigFloat &a, const BigFloat &b);
+    friend BigFloat operator*(const BigFloat &a, const BigFloat &b);
+    BigFloat &operator+=(const BigFloat &b) { return *this = *this + b; }
+
+    friend bool operator==(const BigFloat &a, const BigFloat &b);
+
+private:
+    // Magnitude, least significant limb first: limbs.back() is the integer part
+    std::vector<uint32_t> limbs;
+    bool negative = false;
+
+    bool isZero() const;
+    static int compareMagnitude(const BigFloat &a, const BigFloat &b);
+    static BigFloat addSigned(const BigFloat &a, const BigFloat &b, bool negateB);
+};
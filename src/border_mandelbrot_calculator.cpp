@@ -1,15 +1,25 @@
 #include "border_mandelbrot_calculator.h"
+#include "interior_check.h"
+#include "thread_pool.h"
 #include <cmath>
 #include <algorithm>
+#include <thread>
 
-BorderMandelbrotCalculator::BorderMandelbrotCalculator(int w, int h)
-    : StorageMandelbrotCalculator(w, h), queueHead(0), queueTail(0)
+BorderMandelbrotCalculator::BorderMandelbrotCalculator(int w, int h, bool vectorized)
+    : StorageMandelbrotCalculator(w, h), queueHead(0), queueTail(0), vectorized(vectorized),
+      kernel(SimdKernels::best(SimdKernels::Mode::REFILL, interiorCheck)), outstanding(0)
 {
     done.resize(width * height, 0);
     // Resize to max possible pixels + 1 to prevent ring buffer overflow
     queue.resize(width * height + 1);
 }
 
+void BorderMandelbrotCalculator::setInteriorCheck(bool enabled)
+{
+    StorageMandelbrotCalculator::setInteriorCheck(enabled);
+    kernel = SimdKernels::best(SimdKernels::Mode::REFILL, enabled);
+}
+
 void BorderMandelbrotCalculator::reset()
 {
     StorageMandelbrotCalculator::reset();
@@ -19,10 +29,24 @@ void BorderMandelbrotCalculator::reset()
 
 int BorderMandelbrotCalculator::iterate(double x, double y)
 {
+    if (pointKernel)
+    {
+        IterationCount value;
+        pointKernel(&x, &y, &value, 1, maxIter);
+        return value;
+    }
+
+    if (interiorCheck)
+    {
+        if (inMainCardioidOrBulb(x, y))
+            return maxIter;
+        return iterateWithPeriodicity(x, y, maxIter);
+    }
+
     double r = x, i = y;
     int iter;
 
-    for (iter = 0; iter < MAX_ITER; ++iter)
+    for (iter = 0; iter < maxIter; ++iter)
     {
         double r2 = r * r;
         double i2 = i * i;
@@ -46,12 +70,15 @@ void BorderMandelbrotCalculator::addQueue(unsigned p)
     queue[queueHead++] = p;
     if (queueHead == queue.size())
         queueHead = 0;
+
+    uint64_t depth = queueHead >= queueTail ? queueHead - queueTail : queueHead + queue.size() - queueTail;
+    stats.peakQueue = std::max(stats.peakQueue, depth);
 }
 
-int BorderMandelbrotCalculator::load(unsigned p)
+int BorderMandelbrotCalculator::load(unsigned p, unsigned q)
 {
     if (done[p] & LOADED)
-        return data[p];
+        return out[q];
 
     unsigned x = p % width;
     unsigned y = p / width;
@@ -59,15 +86,111 @@ int BorderMandelbrotCalculator::load(unsigned p)
     int result = iterate(minr + x * stepr, mini + y * stepi);
 
     done[p] |= LOADED;
-    return data[p] = result;
+    storeCount(out[q], result);
+    return result;
+}
+
+void BorderMandelbrotCalculator::requestLoad(unsigned p)
+{
+    if (done[p] & (LOADED | PENDING))
+        return;
+    done[p] |= PENDING;
+    pending.push_back(p);
+    pendingR.push_back(minr + (p % width) * stepr);
+    pendingI.push_back(mini + (p / width) * stepi);
+}
+
+void BorderMandelbrotCalculator::evaluate(const double *cr, const double *ci, IterationCount *values, int count)
+{
+    if (pointKernel)
+        pointKernel(cr, ci, values, count, maxIter);
+    else
+        kernel(cr, ci, values, count, maxIter);
+}
+
+void BorderMandelbrotCalculator::loadBatch(const unsigned *batch, int count)
+{
+    // Collect every pixel the scans of this batch will read: the popped
+    // pixels and their 4 neighbours. The corners are only queued, not read.
+    pending.clear();
+    pendingR.clear();
+    pendingI.clear();
+
+    for (int k = 0; k < count; ++k)
+    {
+        unsigned p = batch[k];
+        int x = p % width;
+        int y = p / width;
+
+        requestLoad(p);
+        if (x >= 1)
+            requestLoad(p - 1);
+        if (x < width - 1)
+            requestLoad(p + 1);
+        if (y >= 1)
+            requestLoad(p - width);
+        if (y < height - 1)
+            requestLoad(p + width);
+    }
+
+    if (pending.empty())
+        return;
+
+    pendingIter.resize(pending.size());
+    evaluate(pendingR.data(), pendingI.data(), pendingIter.data(), static_cast<int>(pending.size()));
+
+    for (size_t k = 0; k < pending.size(); ++k)
+    {
+        unsigned p = pending[k];
+        storeCount(out[outIndex(p)], pendingIter[k]);
+        done[p] = (done[p] & ~PENDING) | LOADED;
+    }
+}
+
+unsigned BorderMandelbrotCalculator::popQueue(unsigned &flag)
+{
+    // Mixed FIFO/LIFO for better visual effect
+    unsigned p;
+    if (queueHead <= queueTail || ++flag & 3 )
+    {
+        // FIFO: dequeue from tail
+        p = queue[queueTail++];
+        if (queueTail == queue.size())
+            queueTail = 0;
+    }
+    else
+    {
+        // LIFO: dequeue from head
+        if (queueHead == 0)
+            queueHead = queue.size();
+        p = queue[--queueHead];
+    }
+    return p;
 }
 
-void BorderMandelbrotCalculator::scan(unsigned p)
+template <bool SHARED>
+void BorderMandelbrotCalculator::scan(unsigned p, Worker *worker)
 {
+    auto load = [this](unsigned p, unsigned q)
+    {
+        if constexpr (SHARED)
+            return loadShared(p, q);
+        else
+            return this->load(p, q);
+    };
+    auto addQueue = [this, worker](unsigned q)
+    {
+        if constexpr (SHARED)
+            addQueueShared(q, *worker);
+        else
+            this->addQueue(q);
+    };
+
     int x = p % width;
     int y = p / width;
+    unsigned q = y * pitch + x;
 
-    int center = load(p);
+    int center = load(p, q);
 
     bool ll = x >= 1;
     bool rr = x < width - 1;
@@ -75,10 +198,10 @@ void BorderMandelbrotCalculator::scan(unsigned p)
     bool dd = y < height - 1;
 
     // Check if neighbors differ from center
-    bool l = ll && load(p - 1) != center;
-    bool r = rr && load(p + 1) != center;
-    bool u = uu && load(p - width) != center;
-    bool d = dd && load(p + width) != center;
+    bool l = ll && load(p - 1, q - 1) != center;
+    bool r = rr && load(p + 1, q + 1) != center;
+    bool u = uu && load(p - width, q - pitch) != center;
+    bool d = dd && load(p + width, q + pitch) != center;
 
     if (l)
         addQueue(p - 1);
@@ -100,13 +223,230 @@ void BorderMandelbrotCalculator::scan(unsigned p)
         addQueue(p + width + 1);
 }
 
+void BorderMandelbrotCalculator::addQueueShared(unsigned p, Worker &worker)
+{
+    std::atomic_ref<unsigned char> flags(done[p]);
+    if (flags.fetch_or(QUEUED, std::memory_order_relaxed) & QUEUED)
+        return;
+
+    // Counted before it can be popped (and before the scan that queued it
+    // is counted as finished), so the count only reaches 0 when all is done
+    unsigned depth = outstanding.fetch_add(1, std::memory_order_acq_rel) + 1;
+    worker.peakQueue = std::max(worker.peakQueue, depth);
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    worker.queue.push_back(p);
+}
+
+int BorderMandelbrotCalculator::loadShared(unsigned p, unsigned q)
+{
+    std::atomic_ref<unsigned char> flags(done[p]);
+    unsigned char state = flags.load(std::memory_order_acquire);
+    if (state & LOADED)
+        return out[q];
+
+    state = flags.fetch_or(CLAIMED, std::memory_order_acq_rel);
+    if (state & LOADED)
+        return out[q];
+
+    int result = iterate(minr + (p % width) * stepr, mini + (p / width) * stepi);
+
+    // If another thread claimed it first, it publishes the (same) value
+    if (!(state & CLAIMED))
+    {
+        storeCount(out[q], result);
+        flags.fetch_or(LOADED, std::memory_order_release);
+    }
+    return result;
+}
+
+void BorderMandelbrotCalculator::requestLoadShared(unsigned p, Worker &worker)
+{
+    // Pixels claimed by another thread (or already in this batch) are left
+    // out; the scan reads them through loadShared
+    std::atomic_ref<unsigned char> flags(done[p]);
+    if (flags.load(std::memory_order_acquire) & LOADED)
+        return;
+    if (flags.fetch_or(CLAIMED, std::memory_order_acq_rel) & (LOADED | CLAIMED))
+        return;
+
+    worker.pending.push_back(p);
+    worker.pendingR.push_back(minr + (p % width) * stepr);
+    worker.pendingI.push_back(mini + (p / width) * stepi);
+}
+
+void BorderMandelbrotCalculator::loadBatchShared(const unsigned *batch, int count, Worker &worker)
+{
+    worker.pending.clear();
+    worker.pendingR.clear();
+    worker.pendingI.clear();
+
+    for (int k = 0; k < count; ++k)
+    {
+        unsigned p = batch[k];
+        int x = p % width;
+        int y = p / width;
+
+        requestLoadShared(p, worker);
+        if (x >= 1)
+            requestLoadShared(p - 1, worker);
+        if (x < width - 1)
+            requestLoadShared(p + 1, worker);
+        if (y >= 1)
+            requestLoadShared(p - width, worker);
+        if (y < height - 1)
+            requestLoadShared(p + width, worker);
+    }
+
+    if (worker.pending.empty())
+        return;
+
+    worker.pendingIter.resize(worker.pending.size());
+    evaluate(worker.pendingR.data(), worker.pendingI.data(), worker.pendingIter.data(),
+             static_cast<int>(worker.pending.size()));
+
+    for (size_t k = 0; k < worker.pending.size(); ++k)
+    {
+        unsigned p = worker.pending[k];
+        storeCount(out[outIndex(p)], worker.pendingIter[k]);
+        std::atomic_ref<unsigned char>(done[p]).fetch_or(LOADED, std::memory_order_release);
+    }
+}
+
+int BorderMandelbrotCalculator::takeWork(unsigned index, unsigned *batch, int limit)
+{
+    int count = 0;
+
+    // Own queue first, newest pixels (depth first keeps the trace local)
+    {
+        Worker &self = *workers[index];
+        std::lock_guard<std::mutex> lock(self.mutex);
+        while (count < limit && !self.queue.empty())
+        {
+            batch[count++] = self.queue.back();
+            self.queue.pop_back();
+        }
+    }
+    if (count > 0)
+        return count;
+
+    // Steal the oldest pixels of another thread
+    for (size_t k = 1; k < workers.size() && count == 0; ++k)
+    {
+        Worker &victim = *workers[(index + k) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        while (count < limit && !victim.queue.empty())
+        {
+            batch[count++] = victim.queue.front();
+            victim.queue.pop_front();
+        }
+    }
+    return count;
+}
+
+void BorderMandelbrotCalculator::traceWorker(unsigned index)
+{
+    Worker &self = *workers[index];
+    unsigned batch[SCAN_BATCH];
+    int limit = vectorized ? SCAN_BATCH : 1;
+
+    for (;;)
+    {
+        // Every thread sees the flag, so they all leave (the count of
+        // outstanding pixels never reaches 0 then)
+        if (isCancelled())
+            return;
+
+        int count = takeWork(index, batch, limit);
+        if (count == 0)
+        {
+            // Queues are empty, but pixels being scanned may queue more
+            if (outstanding.load(std::memory_order_acquire) == 0)
+                return;
+            std::this_thread::yield();
+            continue;
+        }
+
+        if (vectorized)
+            loadBatchShared(batch, count, self);
+        for (int k = 0; k < count; ++k)
+            scan<true>(batch[k], &self);
+
+        outstanding.fetch_sub(count, std::memory_order_acq_rel);
+    }
+}
+
+void BorderMandelbrotCalculator::traceShared(ThreadPool &pool)
+{
+    unsigned threadCount = pool.getThreadCount();
+    if (workers.size() != threadCount)
+    {
+        workers.clear();
+        for (unsigned t = 0; t < threadCount; ++t)
+            workers.push_back(std::make_unique<Worker>());
+    }
+    for (auto &worker : workers)
+    {
+        worker->queue.clear();
+        worker->peakQueue = 0;
+    }
+    outstanding.store(0, std::memory_order_relaxed);
+
+    // Give each thread a contiguous run of the screen edges
+    unsigned edgeCount = 2 * height + 2 * (width - 2);
+    unsigned edge = 0;
+    auto seed = [&](unsigned p)
+    {
+        unsigned owner = static_cast<unsigned>(static_cast<unsigned long long>(edge++) * threadCount / edgeCount);
+        addQueueShared(p, *workers[std::min(owner, threadCount - 1)]);
+    };
+    for (int y = 0; y < height; ++y)
+        seed(y * width + 0);
+    for (int x = 1; x < width - 1; ++x)
+        seed((height - 1) * width + x);
+    for (int y = height - 1; y >= 0; --y)
+        seed(y * width + (width - 1));
+    for (int x = width - 2; x >= 1; --x)
+        seed(0 * width + x);
+
+    // The traced set only depends on pixel values, so the result matches
+    // the single threaded trace whatever the interleaving
+    pool.parallelFor(static_cast<int>(threadCount), [this](int t)
+                     { traceWorker(static_cast<unsigned>(t)); });
+
+    for (auto &worker : workers)
+        stats.peakQueue = std::max<uint64_t>(stats.peakQueue, worker->peakQueue);
+}
+
 void BorderMandelbrotCalculator::compute(std::function<void()> progressCallback)
 {
-    // Start high-precision timer
-    data.assign(width * height, 0);
+    // The calculator is reused across frames: clear the previous trace
+    // (same sizes, so no reallocation). A seeded frame keeps its preview,
+    // and its reused pixels count as loaded: the trace reads them but never
+    // iterates them, and queues the same pixels as it would have.
+    if (!seeded)
+        fillOutput(0);
+    stats.clear();
+    std::fill(done.begin(), done.end(), 0);
+    for (size_t p = 0; p < known.size(); ++p)
+    {
+        if (known[p])
+            done[p] = LOADED;
+    }
+    queueHead = queueTail = 0;
 
     // First Pass: Border Tracing
 
+    ThreadPool &pool = ThreadPool::instance();
+    if (speedMode && pool.getThreadCount() > 1 && !ThreadPool::isInsideJob())
+    {
+        traceShared(pool);
+        if (!isCancelled())
+            fill();
+        countPixels();
+        endSeed();
+        return;
+    }
+
     // Start by adding screen edges to queue
     for (int y = 0; y < height; ++y)
     {
@@ -122,46 +462,119 @@ void BorderMandelbrotCalculator::compute(std::function<void()> progressCallback)
     // Process the queue (mixed FIFO/LIFO for better visual effect)
     unsigned processed = 0;
     unsigned flag = 0;
-    while (queueTail != queueHead)
+    if (vectorized)
     {
-        unsigned p;
-        if (queueHead <= queueTail || ++flag & 3 )
+        // Pop a batch, evaluate all the pixels its scans will read with the
+        // SIMD kernel, then scan. Which pixels get queued only depends on
+        // pixel values, never on the order of the scans, so the traced set
+        // and the fill are exactly those of the scalar path.
+        unsigned batch[SCAN_BATCH];
+        while (queueTail != queueHead && !isCancelled())
         {
-            // FIFO: dequeue from tail
-            p = queue[queueTail++];
-            if (queueTail == queue.size())
-                queueTail = 0;
+            int count = 0;
+            while (count < SCAN_BATCH && queueTail != queueHead)
+                batch[count++] = popQueue(flag);
+
+            loadBatch(batch, count);
+            for (int k = 0; k < count; ++k)
+                scan<false>(batch[k], nullptr);
+
+            // Update display periodically (skip in speed mode)
+            unsigned before = processed;
+            processed += count;
+            if (!speedMode && processed / 1000 != before / 1000)
+            {
+                if (progressCallback)
+                    progressCallback();
+            }
         }
-        else
+    }
+    else
+    {
+        while (queueTail != queueHead && !isCancelled())
         {
-            // LIFO: dequeue from head
-            if (queueHead == 0)
-                queueHead = queue.size();
-            p = queue[--queueHead];
+            scan<false>(popQueue(flag), nullptr);
+
+            // Update display periodically (skip in speed mode)
+            ++processed;
+            if (!speedMode && processed % 1000 == 0)
+            {
+                if (progressCallback)
+                    progressCallback();
+            }
         }
+    }
 
-        scan(p);
+    if (!isCancelled())
+        fill();
+    countPixels();
+    endSeed();
+}
 
-        // Update display periodically (skip in speed mode)
-        ++processed;
-        if (!speedMode && processed % 1000 == 0)
+void BorderMandelbrotCalculator::fill()
+{
+    // Fill uncalculated areas with neighbor color. The first pixel of each
+    // row is on the traced screen edge, so rows can be filled independently.
+    for (int y = 0; y < height; ++y)
+    {
+        unsigned p = y * width;
+        IterationCount *row = &at(0, y);
+
+        for (int x = 0; x < width - 1; ++x, ++p)
         {
-            if (progressCallback)
-                progressCallback();
+            if (done[p] & LOADED)
+            {
+                if (!(done[p + 1] & LOADED))
+                {
+                    storeCount(row[x + 1], row[x]);
+                    done[p + 1] |= LOADED | FILLED;
+                }
+            }
         }
     }
+}
+
+void BorderMandelbrotCalculator::countPixels()
+{
+    // Sort the pixels of the frame by how they got their value (pixels of
+    // a cancelled frame that got none are left out). Branch free so the
+    // pass over the whole frame vectorizes.
+    const unsigned char *reusedFlags = known.empty() ? nullptr : known.data();
+    const unsigned limit = maxIter;
+    uint64_t loaded = 0, filled = 0, reused = 0, interior = 0, iterations = 0;
 
-    // Fill uncalculated areas with neighbor color
-    for (int p = 0; p < width * height - 1; ++p)
+    for (int y = 0; y < height; ++y)
     {
-        if (done[p] & LOADED)
+        const unsigned char *flags = &done[y * width];
+        const unsigned char *rowKnown = reusedFlags ? reusedFlags + y * width : nullptr;
+        const IterationCount *row = &at(0, y);
+        unsigned rowLoaded = 0, rowFilled = 0, rowReused = 0, rowInterior = 0;
+        uint64_t rowIterations = 0;
+
+        for (int x = 0; x < width; ++x)
         {
-            if (!(done[p + 1] & LOADED))
-            {
-                data[p + 1] = data[p];
-                done[p + 1] |= LOADED;
-            }
+            unsigned isLoaded = flags[x] & LOADED;
+            unsigned isFilled = (flags[x] / FILLED) & 1;
+            unsigned isReused = rowKnown ? rowKnown[x] : 0;
+            unsigned isIterated = isLoaded & ~(isFilled | isReused);
+
+            rowLoaded += isLoaded;
+            rowFilled += isFilled;
+            rowReused += isReused;
+            rowInterior += isLoaded & (row[x] >= limit);
+            rowIterations += row[x] & (0u - isIterated);
         }
+
+        loaded += rowLoaded;
+        filled += rowFilled;
+        reused += rowReused;
+        interior += rowInterior;
+        iterations += rowIterations;
     }
 
+    stats.pixelsIterated += loaded - filled - reused;
+    stats.pixelsFilled += filled;
+    stats.pixelsReused += reused;
+    stats.interiorPixels += interior;
+    stats.iterations += iterations;
 }
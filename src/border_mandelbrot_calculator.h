@@ -1,19 +1,31 @@
 #pragma once
 
 #include "storage_mandelbrot_calculator.h"
-#include <vector>
+#include "simd_kernels.h"
+#include <atomic>
+#include <deque>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class ThreadPool;
 
 // Boundary-tracing implementation of Mandelbrot calculator
+// In speed mode the trace runs on all the pool threads over the whole image
+// (unless the calculator is itself a tile computed by the pool).
 class BorderMandelbrotCalculator : public StorageMandelbrotCalculator
 {
 public:
-    BorderMandelbrotCalculator(int width, int height);
+    // vectorized: evaluate the queue in batches with the SIMD kernel
+    BorderMandelbrotCalculator(int width, int height, bool vectorized = false);
 
     void compute(std::function<void()> progressCallback) override;
     void reset() override;
+    void setInteriorCheck(bool enabled) override;
+    void setPointKernel(const PointKernel &kernel) override { pointKernel = kernel; }
     
-    std::string getEngineName() const override { return "border"; }
+    std::string getEngineName() const override { return vectorized ? " bsimd" : "border"; }
 
 private:
     std::vector<unsigned char> done;
@@ -23,11 +35,61 @@ private:
     enum Flags
     {
         LOADED = 1,
-        QUEUED = 2
+        QUEUED = 2,
+        PENDING = 4, // Collected for the current SIMD batch
+        CLAIMED = 8, // Parallel trace: a thread is computing the pixel
+        FILLED = 16  // Set by fill(), not iterated
     };
 
+    // Vectorized mode: queue entries popped per batch, and the pixels
+    // (with their coordinates) the batch needs evaluated
+    static constexpr int SCAN_BATCH = 64;
+    bool vectorized;
+    SimdKernels::Kernel kernel;
+    PointKernel pointKernel; // Set: used instead of kernel and iterate()
+    std::vector<unsigned> pending;
+    std::vector<double> pendingR;
+    std::vector<double> pendingI;
+    std::vector<IterationCount> pendingIter;
+
+    // Pixels are indexed by p = y * width + x (flags, queues); q is the
+    // matching offset in the output, whose pitch may be wider
+    unsigned outIndex(unsigned p) const { return (p / width) * pitch + p % width; }
+
     int iterate(double x, double y);
+    void evaluate(const double *cr, const double *ci, IterationCount *values, int count);
     void addQueue(unsigned p);
-    int load(unsigned p);
-    void scan(unsigned p);
+    unsigned popQueue(unsigned &flag);
+    void requestLoad(unsigned p);
+    void loadBatch(const unsigned *batch, int count);
+    int load(unsigned p, unsigned q);
+    void fill();
+    void countPixels();
+
+    // Parallel trace. The done flags are shared and only updated atomically.
+    // Each thread owns a queue: it pops from the back and idle threads steal
+    // from the front. Pixel values are published by setting LOADED.
+    struct alignas(64) Worker
+    {
+        std::mutex mutex;
+        std::deque<unsigned> queue;
+        std::vector<unsigned> pending;
+        std::vector<double> pendingR;
+        std::vector<double> pendingI;
+        std::vector<IterationCount> pendingIter;
+        unsigned peakQueue = 0; // Most outstanding pixels seen when queueing
+    };
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<int> outstanding; // Queued pixels not scanned yet
+
+    void traceShared(ThreadPool &pool);
+    void traceWorker(unsigned index);
+    int takeWork(unsigned index, unsigned *batch, int limit);
+    void addQueueShared(unsigned p, Worker &worker);
+    int loadShared(unsigned p, unsigned q);
+    void requestLoadShared(unsigned p, Worker &worker);
+    void loadBatchShared(const unsigned *batch, int count, Worker &worker);
+
+    template <bool SHARED>
+    void scan(unsigned p, Worker *worker);
 };
@@ -0,0 +1,53 @@
+#include "calculator_stats.h"
+#include <algorithm>
+#include <format>
+
+void CalculatorStats::add(const CalculatorStats &part)
+{
+    iterations += part.iterations;
+    pixelsIterated += part.pixelsIterated;
+    pixelsFilled += part.pixelsFilled;
+    pixelsReused += part.pixelsReused;
+    interiorPixels += part.interiorPixels;
+    peakQueue = std::max(peakQueue, part.peakQueue);
+    idleMs += part.idleMs;
+    gpuTiles += part.gpuTiles;
+    cachedTiles += part.cachedTiles;
+    gpuDrawMs += part.gpuDrawMs;
+    gpuReadbackMs += part.gpuReadbackMs;
+    referenceLength = std::max(referenceLength, part.referenceLength);
+    referenceMs += part.referenceMs;
+    seriesSkip = std::max(seriesSkip, part.seriesSkip);
+}
+
+std::string CalculatorStats::describe() const
+{
+    uint64_t pixels = pixelsIterated + pixelsFilled + pixelsReused;
+    double iteratedShare = pixels ? 100.0 * pixelsIterated / pixels : 0.0;
+
+    std::string line = std::format("  iterated {} ({:.1f}%)", pixelsIterated, iteratedShare);
+    if (pixelsFilled)
+        line += std::format("  filled {}", pixelsFilled);
+    if (pixelsReused)
+        line += std::format("  reused {}", pixelsReused);
+    if (iterations || interiorPixels) // Unknown for a GPU frame that was not read back
+        line += std::format("  interior {}  iterations {:.3e}", interiorPixels, static_cast<double>(iterations));
+    if (peakQueue)
+        line += std::format("  peak queue {}", peakQueue);
+    if (cachedTiles)
+        line += std::format("  cached tiles {}", cachedTiles);
+
+    if (tileMs.size() > 1)
+    {
+        auto [fastest, slowest] = std::minmax_element(tileMs.begin(), tileMs.end());
+        line += std::format("  tiles {:.1f}-{:.1f} ms  idle {:.1f} ms", *fastest, *slowest, idleMs);
+        if (gpuTiles)
+            line += std::format("  on GPU {}/{}", gpuTiles, tileMs.size());
+    }
+
+    if (gpuDrawMs > 0.0 || gpuReadbackMs > 0.0)
+        line += std::format("  draw {:.1f} ms  readback {:.1f} ms", gpuDrawMs, gpuReadbackMs);
+    if (referenceLength)
+        line += std::format("  reference {} iterations {:.1f} ms  series skip {}", referenceLength, referenceMs, seriesSkip);
+    return line;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Counters of the last compute() of an engine, to tell why a frame was
+// slow. Every pixel of a complete frame is counted once, as iterated,
+// filled or reused; the other fields only concern some engines.
+struct CalculatorStats
+{
+    uint64_t iterations = 0;     // Escape counts of the iterated pixels: exact for escaping
+                                 // points, interior ones count the limit whatever the
+                                 // interior checks saved
+    uint64_t pixelsIterated = 0;
+    uint64_t pixelsFilled = 0;   // Set without iterating (border fill)
+    uint64_t pixelsReused = 0;   // Kept from a seed (previous frame or coarser level)
+    uint64_t interiorPixels = 0; // At the iteration limit
+    uint64_t peakQueue = 0;      // Border tracing: most pixels queued at once
+
+    std::vector<double> tileMs;  // Grid: compute time of each tile
+    double idleMs = 0.0;         // Grid: pool thread time spent without a tile
+    uint64_t gpuTiles = 0;       // Hybrid grid: tiles computed on the GPU
+    uint64_t cachedTiles = 0;    // Grid: tiles copied from the tile cache (their pixels count as reused)
+
+    double gpuDrawMs = 0.0;      // GPU: time the GPU spent drawing
+    double gpuReadbackMs = 0.0;  // GPU: read back and decode (getData() after compute)
+
+    uint64_t referenceLength = 0; // Perturbation: iterations of the reference orbit
+    double referenceMs = 0.0;     // Perturbation: its computation and the series (0 when kept)
+    uint64_t seriesSkip = 0;      // Perturbation: iterations skipped by the series approximation
+
+    void clear() { *this = CalculatorStats(); }
+
+    void countIterated(int value, int maxIter)
+    {
+        ++pixelsIterated;
+        iterations += value;
+        interiorPixels += value >= maxIter;
+    }
+
+    void countReused(int value, int maxIter)
+    {
+        ++pixelsReused;
+        interiorPixels += value >= maxIter;
+    }
+
+    // Adds the counters of a part of the frame (a tile); the peak queue is
+    // the largest one, times are summed
+    void add(const CalculatorStats &part);
+
+    // One line for verbose output; fields that do not apply are left out
+    std::string describe() const;
+};
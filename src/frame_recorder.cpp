@@ -0,0 +1,291 @@
+#include "frame_recorder.h"
+#include "image_stream_writer.h"
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <sys/wait.h>
+
+namespace
+{
+    bool endsWith(const std::string &s, const char *suffix)
+    {
+        size_t n = std::char_traits<char>::length(suffix);
+        return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+    }
+
+    // For the shell that runs ffmpeg
+    std::string shellQuote(const std::string &s)
+    {
+        std::string quoted = "'";
+        for (char c : s)
+        {
+            if (c == '\'')
+                quoted += "'\\''";
+            else
+                quoted += c;
+        }
+        return quoted + "'";
+    }
+
+    // Full range BT.601 (the JPEG convention, "C420jpeg" in Y4M), 16-bit fixed point
+    inline unsigned char lumaOf(int r, int g, int b)
+    {
+        return static_cast<unsigned char>((19595 * r + 38470 * g + 7471 * b + 32768) >> 16);
+    }
+
+    inline unsigned char chromaBlueOf(int r, int g, int b)
+    {
+        return static_cast<unsigned char>(std::clamp(((-11059 * r - 21709 * g + 32768 * b + 32768) >> 16) + 128, 0, 255));
+    }
+
+    inline unsigned char chromaRedOf(int r, int g, int b)
+    {
+        return static_cast<unsigned char>(std::clamp(((32768 * r - 27439 * g - 5329 * b + 32768) >> 16) + 128, 0, 255));
+    }
+}
+
+FrameRecorder::~FrameRecorder()
+{
+    close();
+}
+
+bool FrameRecorder::open(const std::string &outputPath, int w, int h)
+{
+    close();
+
+    path = outputPath;
+    width = w;
+    height = h;
+    framesWritten = 0;
+    framesDropped = 0;
+    failed = false;
+    stopping = false;
+
+    if (endsWith(path, ".y4m"))
+        format = Format::Y4M;
+    else if (endsWith(path, ".mp4") || endsWith(path, ".mkv") || endsWith(path, ".webm") || endsWith(path, ".mov"))
+        format = Format::PIPE;
+    else
+        format = Format::PNG;
+
+    if (format == Format::Y4M)
+    {
+        output = fopen(path.c_str(), "wb");
+    }
+    else if (format == Format::PIPE)
+    {
+        // popen() succeeds whether or not the shell finds ffmpeg
+        if (system("command -v ffmpeg >/dev/null 2>&1") != 0)
+        {
+            std::cerr << "Recording to " << path << " needs ffmpeg" << std::endl;
+            return false;
+        }
+        // A pipe closed by ffmpeg must fail the write, not end the process
+        signal(SIGPIPE, SIG_IGN);
+        // x264 and most codecs want even sizes (the filter is quoted for the
+        // shell, which would stop at its parentheses)
+        std::string command = "ffmpeg -y -loglevel error -f yuv4mpegpipe -i - "
+                              "-vf 'pad=ceil(iw/2)*2:ceil(ih/2)*2' -pix_fmt yuv420p " +
+                              shellQuote(path);
+        output = popen(command.c_str(), "w");
+    }
+    if (format != Format::PNG && !output)
+    {
+        std::cerr << "Cannot write " << path << std::endl;
+        return false;
+    }
+
+    if (format != Format::PNG)
+    {
+        // Flushed, so an ffmpeg that exited at once fails here and not on
+        // the first frames
+        std::string header = std::format("YUV4MPEG2 W{} H{} F{}:1 Ip A1:1 C420jpeg\n", width, height, FRAME_RATE);
+        if (fwrite(header.data(), 1, header.size(), output) != header.size() || fflush(output) != 0)
+        {
+            if (format == Format::PIPE)
+            {
+                int status = pclose(output);
+                std::cerr << "Cannot write " << path << ": ffmpeg exited";
+                if (status != -1 && WIFEXITED(status))
+                    std::cerr << " with status " << WEXITSTATUS(status);
+                std::cerr << std::endl;
+            }
+            else
+            {
+                fclose(output);
+                std::cerr << "Cannot write " << path << std::endl;
+            }
+            output = nullptr;
+            return false;
+        }
+    }
+
+    // Allocated once: frames are copied into these for the whole recording
+    buffers.assign(RING_SIZE, std::vector<uint32_t>(static_cast<size_t>(width) * height));
+    freeBuffers.clear();
+    queuedBuffers.clear();
+    for (int i = 0; i < RING_SIZE; ++i)
+        freeBuffers.push_back(i);
+    acquired = -1;
+
+    encoder = std::thread(&FrameRecorder::encoderLoop, this);
+    return true;
+}
+
+uint32_t *FrameRecorder::acquire()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!encoder.joinable() || failed || freeBuffers.empty())
+    {
+        ++framesDropped;
+        return nullptr;
+    }
+
+    acquired = freeBuffers.front();
+    freeBuffers.pop_front();
+    return buffers[acquired].data();
+}
+
+void FrameRecorder::submit()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (acquired < 0)
+            return;
+        queuedBuffers.push_back(acquired);
+        acquired = -1;
+    }
+    wakeCondition.notify_one();
+}
+
+bool FrameRecorder::hasFailed()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return failed;
+}
+
+bool FrameRecorder::close()
+{
+    if (!encoder.joinable())
+        return false;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeCondition.notify_one();
+    encoder.join();
+
+    bool closed = true;
+    if (output)
+    {
+        // pclose waits for ffmpeg to finish the file
+        closed = (format == Format::PIPE ? pclose(output) : fclose(output)) == 0;
+        output = nullptr;
+    }
+    buffers.clear();
+    buffers.shrink_to_fit();
+    return closed && !failed;
+}
+
+void FrameRecorder::encoderLoop()
+{
+    for (;;)
+    {
+        int index;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeCondition.wait(lock, [this]()
+                               { return stopping || !queuedBuffers.empty(); });
+            if (queuedBuffers.empty())
+                return; // Stopping, and every queued frame is written
+            index = queuedBuffers.front();
+            queuedBuffers.pop_front();
+        }
+
+        // The buffer is only the encoder's until it is back in the free list
+        bool written = !failed && encode(buffers[index]);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (written)
+        {
+            ++framesWritten;
+        }
+        else if (!failed)
+        {
+            std::cerr << "Recording: cannot write " << path << std::endl;
+            failed = true;
+        }
+        freeBuffers.push_back(index);
+    }
+}
+
+bool FrameRecorder::encode(const std::vector<uint32_t> &frame)
+{
+    return format == Format::PNG ? writePng(frame) : writeY4M(frame);
+}
+
+bool FrameRecorder::writeY4M(const std::vector<uint32_t> &frame)
+{
+    // Y plane, then the U and V planes at half resolution (rounded up), each
+    // chroma sample the average of its 2x2 block (or what of it is inside)
+    const int chromaWidth = (width + 1) / 2;
+    const int chromaHeight = (height + 1) / 2;
+    const size_t lumaSize = static_cast<size_t>(width) * height;
+    const size_t chromaSize = static_cast<size_t>(chromaWidth) * chromaHeight;
+    scratch.resize(lumaSize + 2 * chromaSize);
+    unsigned char *luma = scratch.data();
+    unsigned char *blue = luma + lumaSize;
+    unsigned char *red = blue + chromaSize;
+
+    for (size_t p = 0; p < lumaSize; ++p)
+    {
+        uint32_t c = frame[p];
+        luma[p] = lumaOf((c >> 16) & 0xFF, (c >> 8) & 0xFF, c & 0xFF);
+    }
+
+    for (int cy = 0; cy < chromaHeight; ++cy)
+    {
+        for (int cx = 0; cx < chromaWidth; ++cx)
+        {
+            int r = 0, g = 0, b = 0, n = 0;
+            for (int y = 2 * cy; y < std::min(height, 2 * cy + 2); ++y)
+            {
+                for (int x = 2 * cx; x < std::min(width, 2 * cx + 2); ++x)
+                {
+                    uint32_t c = frame[static_cast<size_t>(y) * width + x];
+                    r += (c >> 16) & 0xFF;
+                    g += (c >> 8) & 0xFF;
+                    b += c & 0xFF;
+                    ++n;
+                }
+            }
+            size_t q = static_cast<size_t>(cy) * chromaWidth + cx;
+            blue[q] = chromaBlueOf(r / n, g / n, b / n);
+            red[q] = chromaRedOf(r / n, g / n, b / n);
+        }
+    }
+
+    return fwrite("FRAME\n", 1, 6, output) == 6 &&
+           fwrite(scratch.data(), 1, scratch.size(), output) == scratch.size();
+}
+
+bool FrameRecorder::writePng(const std::vector<uint32_t> &frame)
+{
+    const size_t pixels = static_cast<size_t>(width) * height;
+    scratch.resize(pixels * 3);
+    for (size_t p = 0; p < pixels; ++p)
+    {
+        scratch[p * 3] = static_cast<unsigned char>(frame[p] >> 16);
+        scratch[p * 3 + 1] = static_cast<unsigned char>(frame[p] >> 8);
+        scratch[p * 3 + 2] = static_cast<unsigned char>(frame[p]);
+    }
+
+    // The streaming writer's run-length deflate is much faster than stb's
+    // on escape time images, which keeps the encoder ahead of the frames
+    ImageStreamWriter writer;
+    std::string name = std::format("{}-{:06}.png", path, framesWritten.load());
+    return writer.open(name, width, height) && writer.writeRows(scratch.data(), height) && writer.close();
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Records frames to a video or an image sequence, encoded and written on a
+// background thread. Frames are copied into a fixed ring of reusable
+// buffers; when the encoder falls behind and every buffer is queued, new
+// frames are dropped (and counted) instead of waited for, so the caller
+// never blocks on the disk or on compression.
+// The format follows the file extension: ".y4m" gives raw YUV 4:2:0 video
+// (full range, FRAME_RATE frames per second), ".mp4", ".mkv", ".webm" and
+// ".mov" the same video piped to ffmpeg, and anything else a PNG sequence
+// (path-000000.png, path-000001.png, ...).
+class FrameRecorder
+{
+public:
+    static constexpr int RING_SIZE = 8;
+    static constexpr int FRAME_RATE = 30;
+
+    FrameRecorder() = default;
+    ~FrameRecorder();
+
+    FrameRecorder(const FrameRecorder &) = delete;
+    FrameRecorder &operator=(const FrameRecorder &) = delete;
+
+    // Returns false (after reporting on std::cerr) if the output cannot be created
+    bool open(const std::string &path, int width, int height);
+
+    // A free buffer of width * height 0x00RRGGBB pixels, rows top to bottom,
+    // or null if all of them are queued (the frame is dropped). Passed back
+    // with submit().
+    uint32_t *acquire();
+    void submit();
+
+    // Encodes the frames still queued, then completes the output
+    bool close();
+
+    bool isOpen() const { return encoder.joinable(); }
+    // A write failed (ffmpeg exited, disk full): frames are dropped from then on
+    bool hasFailed();
+    int getFramesWritten() const { return framesWritten; }
+    int getFramesDropped() const { return framesDropped; }
+    const std::string &getPath() const { return path; }
+
+private:
+    enum class Format
+    {
+        Y4M,
+        PIPE, // Y4M into ffmpeg
+        PNG
+    };
+
+    Format format = Format::Y4M;
+    std::string path;
+    int width = 0;
+    int height = 0;
+    FILE *output = nullptr; // Y4M file or ffmpeg pipe
+
+    std::vector<std::vector<uint32_t>> buffers;
+    std::deque<int> freeBuffers;
+    std::deque<int> queuedBuffers; // Oldest first
+    int acquired = -1;             // Buffer handed out by acquire()
+
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::thread encoder;
+    bool stopping = false;
+    bool failed = false; // Set by the encoder, frames are then dropped
+
+    std::atomic<int> framesWritten{0}; // By the encoder thread
+    int framesDropped = 0;             // By the caller thread
+
+    // Encoder thread only
+    std::vector<unsigned char> scratch;
+
+    void encoderLoop();
+    bool encode(const std::vector<uint32_t> &frame);
+    bool writeY4M(const std::vector<uint32_t> &frame);
+    bool writePng(const std::vector<uint32_t> &frame);
+};
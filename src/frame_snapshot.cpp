@@ -0,0 +1,45 @@
+#include "frame_snapshot.h"
+#include <cmath>
+
+void FrameSnapshot::capture(const MandelbrotCalculator &calculator)
+{
+    width = calculator.getWidth();
+    height = calculator.getHeight();
+    minR = calculator.getMinR();
+    minI = calculator.getMinI();
+    stepR = calculator.getStepR();
+    stepI = calculator.getStepI();
+    maxIter = calculator.getMaxIterations();
+    const IterationCount *counts = calculator.getCounts();
+    data.assign(counts, counts + static_cast<size_t>(width) * height);
+    valid.clear();
+}
+
+void FrameSnapshot::mapAxis(double min, double step, int count,
+                            double oldMin, double oldStep, int oldCount,
+                            std::vector<int> &source, std::vector<unsigned char> &exact)
+{
+    // Positions are compared in old pixels. Samples computed through
+    // different bounds only agree to rounding, so "on a sample" allows a
+    // millionth of a pixel; at depths where rounding reaches that, nothing
+    // matches and the frame is simply recomputed.
+    const double tolerance = 1e-6;
+
+    source.resize(count);
+    exact.resize(count);
+    for (int i = 0; i < count; ++i)
+    {
+        double position = (min + i * step - oldMin) / oldStep;
+        double nearest = std::round(position);
+
+        if (nearest < 0.0 || nearest >= oldCount)
+        {
+            source[i] = -1;
+            exact[i] = 0;
+            continue;
+        }
+
+        source[i] = static_cast<int>(nearest);
+        exact[i] = std::abs(position - nearest) <= tolerance;
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "mandelbrot_calculator.h"
+#include <vector>
+
+// Pixels of a computed frame together with the sample grid they were
+// computed on, used to seed the next frame of a zoom or pan
+struct FrameSnapshot
+{
+    int width = 0;
+    int height = 0;
+    double minR = 0.0, minI = 0.0;
+    double stepR = 0.0, stepI = 0.0;
+    int maxIter = 0;
+    std::vector<IterationCount> data;
+
+    // Empty when every pixel is final; otherwise only the marked pixels can
+    // be reused, the others are a preview
+    std::vector<unsigned char> valid;
+
+    bool empty() const { return data.empty(); }
+    void capture(const MandelbrotCalculator &calculator);
+
+    // Maps the samples min + i * step (i in [0, count)) of a new frame axis
+    // to the old one. source[i] is the nearest old sample (-1 outside the old
+    // frame) and exact[i] is set when the new sample lies on it.
+    static void mapAxis(double min, double step, int count,
+                        double oldMin, double oldStep, int oldCount,
+                        std::vector<int> &source, std::vector<unsigned char> &exact);
+};
@@ -1,9 +1,26 @@
 #include "gpu_mandelbrot_calculator.h"
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <vector>
 
-GpuMandelbrotCalculator::GpuMandelbrotCalculator(int w, int h, Precision prec)
-    : ZoomMandelbrotCalculator(w, h), precision(prec), programId(0), vao(0), vbo(0), fbo(0), texture(0)
+// Vertex Shader - GLSL 4.0 Core (full screen quad, shared by both passes)
+static const std::string vsSource = R"(
+    #version 400 core
+    in vec2 position;
+    out vec2 texCoord;
+    void main() {
+        gl_Position = vec4(position, 0.0, 1.0);
+        // Map from [-1, 1] to [0, 1]
+        texCoord = position * 0.5 + 0.5;
+    }
+)";
+
+GpuMandelbrotCalculator::GpuMandelbrotCalculator(int w, int h, Precision prec, Pipeline pipe)
+    : ZoomMandelbrotCalculator(w, h), dataStale(false), precision(prec), pipeline(pipe), programId(0), vao(0), vbo(0), fbo(0), texture(0),
+      pbo{0, 0}, stripHeight(0), countBuffer(0), orbitBuffer(0), groupBuffer(0), readbackBuffer{0, 0}, bandRows(0),
+      colorProgramId(0), displayFbo(0), displayTarget(0), paletteTexture(0),
+      paletteDirty(false), timerQuery(0), timerPending(false)
 {
     data.resize(width * height);
 
@@ -17,9 +34,40 @@ GpuMandelbrotCalculator::GpuMandelbrotCalculator(int w, int h, Precision prec)
 
     // OpenGL context verified
 
-    initShaders();
-    initGeometry();
-    initFBO();
+    // Without compute shaders the same precision runs as a fragment shader,
+    // reported once rather than on every frame
+    if (pipeline == Pipeline::COMPUTE && !computeSupported())
+    {
+        static bool reported = false;
+        if (!reported)
+        {
+            GLint major = 0;
+            GLint minor = 0;
+            glGetIntegerv(GL_MAJOR_VERSION, &major);
+            glGetIntegerv(GL_MINOR_VERSION, &minor);
+            std::cerr << "The compute engine needs OpenGL 4.3 (the context is " << major << "." << minor
+                      << "), using the fragment shader" << std::endl;
+            reported = true;
+        }
+        pipeline = Pipeline::FRAGMENT;
+    }
+
+    if (pipeline == Pipeline::COMPUTE)
+    {
+        initComputeShaders();
+        initColorShaders();
+        initGeometry();
+        initComputeBuffers();
+    }
+    else
+    {
+        initShaders();
+        initColorShaders();
+        initGeometry();
+        initFBO();
+        initPBO();
+    }
+    glGenQueries(1, &timerQuery);
 }
 
 GpuMandelbrotCalculator::~GpuMandelbrotCalculator()
@@ -34,10 +82,34 @@ GpuMandelbrotCalculator::~GpuMandelbrotCalculator()
         glDeleteFramebuffers(1, &fbo);
     if (texture)
         glDeleteTextures(1, &texture);
+    if (pbo[0])
+        glDeleteBuffers(2, pbo);
+    if (countBuffer)
+        glDeleteBuffers(1, &countBuffer);
+    if (orbitBuffer)
+        glDeleteBuffers(1, &orbitBuffer);
+    if (groupBuffer)
+        glDeleteBuffers(1, &groupBuffer);
+    if (readbackBuffer[0])
+        glDeleteBuffers(2, readbackBuffer);
+    if (timerQuery)
+        glDeleteQueries(1, &timerQuery);
+    if (colorProgramId)
+        glDeleteProgram(colorProgramId);
+    if (displayFbo)
+        glDeleteFramebuffers(1, &displayFbo);
+    if (paletteTexture)
+        glDeleteTextures(1, &paletteTexture);
 }
 
 void GpuMandelbrotCalculator::compute(std::function<void()> progressCallback)
 {
+    if (pipeline == Pipeline::COMPUTE)
+    {
+        computeBands(progressCallback);
+        return;
+    }
+
     if (!programId || !fbo)
     {
         std::cerr << "Program or FBO missing." << std::endl;
@@ -51,26 +123,232 @@ void GpuMandelbrotCalculator::compute(std::function<void()> progressCallback)
     glUseProgram(programId);
 
     // Update uniforms
-    glUniform1d(locMinR, minr);
-    glUniform1d(locMinI, mini);
-    glUniform1d(locMaxR, maxr);
-    glUniform1d(locMaxI, maxi);
-    glUniform1i(locMaxIter, MAX_ITER);
+    if (precision == Precision::DOUBLE_FLOAT)
+    {
+        // Each double split in the float nearest to it and the float nearest
+        // to the rest. Rows go up from the bottom of the view (maxi).
+        auto upload = [](GLint location, double value)
+        {
+            float hi = static_cast<float>(value);
+            glUniform2f(location, hi, static_cast<float>(value - hi));
+        };
+        upload(locOriginR, minr);
+        upload(locOriginI, maxi);
+        upload(locStepR, (maxr - minr) / width);
+        upload(locStepI, -(maxi - mini) / height);
+    }
+    else
+    {
+        glUniform1d(locMinR, minr);
+        glUniform1d(locMinI, mini);
+        glUniform1d(locMaxR, maxr);
+        glUniform1d(locMaxI, maxi);
+    }
+    glUniform1i(locMaxIter, maxIter);
 
-    // Draw full screen quad using VAO
+    // Draw full screen quad using VAO. No wait and no readback here: the
+    // display pass and getData() both pick the frame up from the FBO.
+    // The draw time is measured on the GPU and collected by getStats().
+    stats.clear();
+    stats.pixelsIterated = static_cast<uint64_t>(width) * height;
+    glBeginQuery(GL_TIME_ELAPSED, timerQuery);
     glBindVertexArray(vao);
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
     glBindVertexArray(0);
+    glEndQuery(GL_TIME_ELAPSED);
+    timerPending = true;
+
+    glUseProgram(0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    dataStale = true;
+
+    if (progressCallback)
+        progressCallback();
+}
+
+void GpuMandelbrotCalculator::computeBands(const std::function<void()> &progressCallback)
+{
+    if (!programId || !countBuffer)
+    {
+        std::cerr << "Compute program or storage buffers missing." << std::endl;
+        return;
+    }
+
+    glUseProgram(programId);
+    glUniform1d(locMinR, minr);
+    glUniform1d(locMinI, mini);
+    glUniform1d(locStepRd, stepr);
+    glUniform1d(locStepId, stepi);
+    glUniform2i(locSize, width, height);
+    glUniform1i(locMaxIter, maxIter);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, countBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, orbitBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, groupBuffer);
 
+    // The timer covers the passes and copies of all bands (and the display
+    // passes the progress callback queues between them)
+    stats.clear();
+    stats.pixelsIterated = static_cast<uint64_t>(width) * height;
+    glBeginQuery(GL_TIME_ELAPSED, timerQuery);
+
+    // Band k is computed and copied to readbackBuffer[k % 2], then band k-1
+    // is mapped and decoded while band k is in flight, as in readback().
+    // A cancelled frame stops after the band in flight.
+    int groupsX = (width + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE;
+    int bands = (height + bandRows - 1) / bandRows;
+    for (int k = 0; k <= bands; ++k)
+    {
+        bool cancelled = isCancelled();
+        if (k < bands && !cancelled)
+        {
+            int y0 = k * bandRows;
+            int rows = std::min(bandRows, height - y0);
+            int groupsY = (rows + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE;
+
+            glUniform1i(locBandY, y0);
+            for (int first = 0; first < maxIter; first += ITERATIONS_PER_PASS)
+            {
+                glUniform1i(locFirstIter, first);
+                glUniform1i(locLastIter, std::min(first + ITERATIONS_PER_PASS, maxIter));
+                glDispatchCompute(groupsX, groupsY, 1);
+                // The next pass reads the orbits and flags written by this one
+                glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+                glFlush(); // Each pass is submitted on its own
+            }
+
+            glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+            glBindBuffer(GL_COPY_READ_BUFFER, countBuffer);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, readbackBuffer[k % 2]);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(y0) * width * 4, 0,
+                                static_cast<GLsizeiptr>(rows) * width * 4);
+            if (k == bands - 1)
+                glEndQuery(GL_TIME_ELAPSED);
+        }
+        else if (k < bands)
+        {
+            glEndQuery(GL_TIME_ELAPSED);
+        }
+
+        if (k > 0)
+        {
+            int y0 = (k - 1) * bandRows;
+            int rows = std::min(bandRows, height - y0);
+
+            auto readStart = std::chrono::steady_clock::now();
+            glBindBuffer(GL_COPY_WRITE_BUFFER, readbackBuffer[(k - 1) % 2]);
+            const uint32_t *counts = static_cast<const uint32_t *>(
+                glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, static_cast<GLsizeiptr>(rows) * width * 4, GL_MAP_READ_BIT));
+            if (counts)
+            {
+                decodeBand(counts, y0, rows);
+                glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+            }
+            // Includes waiting for the band when it had not finished yet
+            stats.gpuReadbackMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - readStart).count();
+
+            if (progressCallback)
+            {
+                // The callback may draw with the GL context
+                glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+                glUseProgram(0);
+                progressCallback();
+                glUseProgram(programId);
+                glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, countBuffer);
+                glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, orbitBuffer);
+                glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, groupBuffer);
+            }
+        }
+
+        if (cancelled)
+            break;
+    }
+    timerPending = true;
+
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
     glUseProgram(0);
 
-    // Force GPU to finish
-    glFinish();
+    GLenum err;
+    while ((err = glGetError()) != GL_NO_ERROR)
+    {
+        std::cerr << "OpenGL Error during compute: " << err << std::endl;
+    }
+}
 
-    // Read back pixels
-    // We read RGBA unsigned bytes
-    std::vector<uint8_t> pixels(width * height * 4);
-    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+void GpuMandelbrotCalculator::decodeBand(const uint32_t *counts, int y0, int rows)
+{
+    // The low 16 bits are the count, the top bit only marks it final
+    IterationCount *dst = &data[static_cast<size_t>(y0) * width];
+    int pixels = rows * width;
+    for (int k = 0; k < pixels; ++k)
+    {
+        IterationCount value = static_cast<IterationCount>(std::min<uint32_t>(counts[k] & 0xffff, maxIter));
+        dst[k] = value;
+        stats.iterations += value;
+        stats.interiorPixels += value >= maxIter;
+    }
+}
+
+const std::vector<IterationCount> &GpuMandelbrotCalculator::getData() const
+{
+    if (dataStale)
+        readback();
+    return data;
+}
+
+void GpuMandelbrotCalculator::readback() const
+{
+    dataStale = false;
+    if (!pbo[0])
+        return;
+
+    auto readStart = std::chrono::steady_clock::now();
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+    // Strip k is queued into pbo[k % 2] (glReadPixels into a bound pack
+    // buffer returns at once), then strip k-1 is mapped and decoded while
+    // strip k is in flight. Mapping is the only synchronization point.
+    int strips = (height + stripHeight - 1) / stripHeight;
+    for (int k = 0; k <= strips; ++k)
+    {
+        if (k < strips)
+        {
+            int y0 = k * stripHeight;
+            int rows = std::min(stripHeight, height - y0);
+
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo[k % 2]);
+            glReadPixels(0, y0, width, rows, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        }
+
+        if (k > 0)
+        {
+            int y0 = (k - 1) * stripHeight;
+            int rows = std::min(stripHeight, height - y0);
+
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo[(k - 1) % 2]);
+            const uint8_t *pixels = static_cast<const uint8_t *>(
+                glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(width) * rows * 4, GL_MAP_READ_BIT));
+            if (pixels)
+            {
+                decodeStrip(pixels, y0, rows);
+                glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            }
+        }
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    // Includes waiting for the draw when it had not finished yet
+    stats.gpuReadbackMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - readStart).count();
+    stats.iterations = 0;
+    stats.interiorPixels = 0;
+    for (IterationCount value : data)
+    {
+        stats.iterations += value;
+        stats.interiorPixels += value >= maxIter;
+    }
 
     // Check for GL errors
     GLenum err;
@@ -80,7 +358,106 @@ void GpuMandelbrotCalculator::compute(std::function<void()> progressCallback)
     }
 
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+const CalculatorStats &GpuMandelbrotCalculator::getStats() const
+{
+    // Waits for the draw if the GPU is still at it. Iteration counts are
+    // only known once the frame was read back.
+    if (timerPending)
+    {
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(timerQuery, GL_QUERY_RESULT, &nanoseconds);
+        stats.gpuDrawMs = nanoseconds / 1.0e6;
+        timerPending = false;
+    }
+    return stats;
+}
+
+void GpuMandelbrotCalculator::setPalette(const std::vector<uint32_t> &newPalette)
+{
+    // Only upload when the colors (or the iteration limit) changed
+    if (newPalette != palette)
+    {
+        palette = newPalette;
+        paletteDirty = true;
+    }
+}
+
+void GpuMandelbrotCalculator::render(unsigned targetTexture)
+{
+    if (!colorProgramId || !targetTexture || palette.empty())
+        return;
+
+    // The caller's GL state (SDL renderer) is restored afterwards
+    GLint savedViewport[4];
+    GLint savedTexture;
+    glGetIntegerv(GL_VIEWPORT, savedViewport);
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &savedTexture);
 
+    glActiveTexture(GL_TEXTURE1);
+    if (!paletteTexture)
+    {
+        glGenTextures(1, &paletteTexture);
+        glBindTexture(GL_TEXTURE_2D, paletteTexture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+    glBindTexture(GL_TEXTURE_2D, paletteTexture);
+    if (paletteDirty)
+    {
+        // 256 entries per row: the palette can be longer than the maximum
+        // 1D texture size. ARGB words upload as BGRA bytes.
+        int rows = static_cast<int>((palette.size() + 255) / 256);
+        std::vector<uint32_t> padded(palette);
+        padded.resize(rows * 256, palette.back());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 256, rows, 0, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, padded.data());
+        paletteDirty = false;
+    }
+
+    glActiveTexture(GL_TEXTURE0);
+    if (pipeline == Pipeline::COMPUTE)
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, countBuffer);
+    else
+        glBindTexture(GL_TEXTURE_2D, texture);
+
+    if (!displayFbo)
+        glGenFramebuffers(1, &displayFbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, displayFbo);
+    if (displayTarget != targetTexture)
+    {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, targetTexture, 0);
+        displayTarget = targetTexture;
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cerr << "Display framebuffer is not complete!" << std::endl;
+    }
+    glViewport(0, 0, width, height);
+
+    glUseProgram(colorProgramId);
+    glUniform1i(locPalette, 1);
+    if (pipeline == Pipeline::COMPUTE)
+    {
+        glUniform1i(locWidth, width);
+    }
+    else
+    {
+        glUniform1i(locIterations, 0);
+        glUniform1i(locHeight, height);
+    }
+
+    glBindVertexArray(vao);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    glBindVertexArray(0);
+
+    glUseProgram(0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, savedTexture);
+    glViewport(savedViewport[0], savedViewport[1], savedViewport[2], savedViewport[3]);
+}
+
+void GpuMandelbrotCalculator::decodeStrip(const uint8_t *pixels, int glY, int rows) const
+{
     // Convert pixels to iteration counts
     // Shader encodes: R = low byte, G = high byte
     // The shader already flips Y coordinate: cy = minI + (1.0 - texCoord.y) * (maxI - minI)
@@ -89,33 +466,21 @@ void GpuMandelbrotCalculator::compute(std::function<void()> progressCallback)
     // glReadPixels reads from y=0 (bottom) to y=height-1 (top) in GL coordinates
     // We want our data buffer to have y=0 at top (minI), so we flip during readback
 
-    for (int y = 0; y < height; ++y)
+    for (int y = 0; y < rows; ++y)
     {
-        // glReadPixels gives us bottom row first (y=0 in GL = bottom)
-        // We want top row first (y=0 in CPU = top = minI)
-        // So flip: GL row y -> CPU row (height-1-y)
-
+        // GL row glY + y -> CPU row (height - 1 - (glY + y))
         const uint8_t *srcRow = &pixels[y * width * 4];
-        int *dstRow = &data[(height - 1 - y) * width];
+        IterationCount *dstRow = &data[(height - 1 - (glY + y)) * width];
 
         for (int x = 0; x < width; ++x)
         {
-            uint8_t r = srcRow[x * 4 + 0];
-            uint8_t g = srcRow[x * 4 + 1];
-            // uint8_t b = srcRow[x * 4 + 2];
-
             // Decode iteration count
-            int iter = r + (g * 256);
-            if (iter > MAX_ITER)
-                iter = MAX_ITER;
-
-            dstRow[x] = iter;
+            int iter = srcRow[x * 4 + 0] + (srcRow[x * 4 + 1] << 8);
+            dstRow[x] = std::min(iter, maxIter);
         }
     }
-
-    if (progressCallback)
-        progressCallback();
 }
+
 void GpuMandelbrotCalculator::reset()
 {
     // Nothing to reset for GPU
@@ -142,6 +507,50 @@ void GpuMandelbrotCalculator::initFBO()
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
+void GpuMandelbrotCalculator::initPBO()
+{
+    stripHeight = (height + READBACK_STRIPS - 1) / READBACK_STRIPS;
+
+    glGenBuffers(2, pbo);
+    for (GLuint buffer : pbo)
+    {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(width) * stripHeight * 4, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void GpuMandelbrotCalculator::initComputeBuffers()
+{
+    // Bands are whole workgroup rows, of about BAND_PIXELS pixels
+    int groupsX = (width + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE;
+    int groupRows = (height + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE;
+    bandRows = WORKGROUP_SIZE * std::clamp(BAND_PIXELS / (width * WORKGROUP_SIZE), 1, groupRows);
+
+    GLsizeiptr bandPixels = static_cast<GLsizeiptr>(width) * bandRows;
+    GLsizeiptr scalarSize = precision == Precision::FLOAT ? sizeof(float) : sizeof(double);
+
+    glGenBuffers(1, &countBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, countBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(width) * height * 4, nullptr, GL_DYNAMIC_COPY);
+
+    glGenBuffers(1, &orbitBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, orbitBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, bandPixels * 2 * scalarSize, nullptr, GL_DYNAMIC_COPY);
+
+    glGenBuffers(1, &groupBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, groupBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(groupsX) * (bandRows / WORKGROUP_SIZE) * 4, nullptr, GL_DYNAMIC_COPY);
+
+    glGenBuffers(2, readbackBuffer);
+    for (GLuint buffer : readbackBuffer)
+    {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, bandPixels * 4, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
 void GpuMandelbrotCalculator::initGeometry()
 {
     // Full screen quad coordinates (-1 to 1)
@@ -169,22 +578,17 @@ void GpuMandelbrotCalculator::initGeometry()
 
 void GpuMandelbrotCalculator::initShaders()
 {
+    if (precision == Precision::DOUBLE_FLOAT)
+    {
+        initDoubleFloatShaders();
+        return;
+    }
+
     // Configure precision type for shader based on constructor parameter
     // float:  ~45ms on Intel integrated GPU, precision good to zoom ~1e-6
     // double: ~545ms on Intel integrated GPU, precision good to zoom ~1e-15
     const char *precisionType = (precision == Precision::FLOAT) ? "float" : "double";
 
-    // Vertex Shader - GLSL 4.0 Core
-    const std::string vsSource = R"(
-        #version 400 core
-        in vec2 position;
-        out vec2 texCoord;
-        void main() {
-            gl_Position = vec4(position, 0.0, 1.0);
-            // Map from [-1, 1] to [0, 1]
-            texCoord = position * 0.5 + 0.5;
-        }
-    )";
 
     // Fragment Shader - GLSL 4.0 Core with configurable precision
     // Encodes iteration count into RGBA
@@ -258,33 +662,365 @@ void GpuMandelbrotCalculator::initShaders()
     GLuint vs = compileShader(GL_VERTEX_SHADER, vsSource);
     GLuint fs = compileShader(GL_FRAGMENT_SHADER, fsSource);
 
-    programId = glCreateProgram();
-    glAttachShader(programId, vs);
-    glAttachShader(programId, fs);
+    programId = linkProgram(vs, fs);
+
+    // Get uniform locations
+    locMinR = glGetUniformLocation(programId, "minR");
+    locMinI = glGetUniformLocation(programId, "minI");
+    locMaxR = glGetUniformLocation(programId, "maxR");
+    locMaxI = glGetUniformLocation(programId, "maxI");
+    locMaxIter = glGetUniformLocation(programId, "maxIter");
+}
+
+void GpuMandelbrotCalculator::initDoubleFloatShaders()
+{
+    // Float-float: a value is the unevaluated sum hi + lo of two floats, so
+    // it carries ~48 bits with float arithmetic only. Good to zoom ~1e-11
+    // (a coordinate ulp is ~7e-15 near |c| = 2, a pixel must span several)
+    // at a few times the cost of float, where double runs at a fraction of
+    // the float rate on most consumer GPUs.
+    // The error terms are exact only if the compiler neither reassociates nor
+    // contracts them: every intermediate is declared precise, and products
+    // get their rounding error from fma (core in GLSL 4.0).
+    const std::string fsSource = R"(
+        #version 400 core
+
+        uniform vec2 originR; // Real part of the left edge
+        uniform vec2 originI; // Imaginary part of the bottom edge
+        uniform vec2 stepR;   // Per pixel
+        uniform vec2 stepI;
+        uniform int maxIter;
+
+        out vec4 fragColor;
+
+        // a + b with its rounding error, |a| >= |b|
+        vec2 quickTwoSum(float a, float b) {
+            precise float s = a + b;
+            precise float e = b - (s - a);
+            return vec2(s, e);
+        }
+
+        // a + b with its rounding error
+        vec2 twoSum(float a, float b) {
+            precise float s = a + b;
+            precise float v = s - a;
+            precise float e = (a - (s - v)) + (b - v);
+            return vec2(s, e);
+        }
+
+        // a * b with its rounding error: fma rounds once, so a * b - p is exact
+        vec2 twoProd(float a, float b) {
+            precise float p = a * b;
+            precise float e = fma(a, b, -p);
+            return vec2(p, e);
+        }
+
+        vec2 ffAdd(vec2 a, vec2 b) {
+            vec2 s = twoSum(a.x, b.x);
+            vec2 t = twoSum(a.y, b.y);
+            precise float lo = s.y + t.x;
+            s = quickTwoSum(s.x, lo);
+            lo = s.y + t.y;
+            return quickTwoSum(s.x, lo);
+        }
+
+        vec2 ffMul(vec2 a, vec2 b) {
+            vec2 p = twoProd(a.x, b.x);
+            precise float lo = p.y + (a.x * b.y + a.y * b.x);
+            return quickTwoSum(p.x, lo);
+        }
+
+        vec2 ffMul(vec2 a, float b) {
+            vec2 p = twoProd(a.x, b);
+            precise float lo = p.y + a.y * b;
+            return quickTwoSum(p.x, lo);
+        }
+
+        void main() {
+            // gl_FragCoord is the pixel center (x + 0.5), exact in a float;
+            // GL row 0 is the bottom of the view
+            vec2 x = ffAdd(originR, ffMul(stepR, gl_FragCoord.x));
+            vec2 y = ffAdd(originI, ffMul(stepI, gl_FragCoord.y));
+
+            // Start with z = c (matching CPU implementation)
+            vec2 r = x;
+            vec2 i = y;
+            vec2 r2;
+            vec2 i2;
+
+            int iter = 0;
+            for (int k = 0; k < maxIter; ++k) {
+                r2 = ffMul(r, r);
+                i2 = ffMul(i, i);
+
+                // The high parts decide: the low ones are below a float ulp of 4
+                if (r2.x + i2.x >= 4.0) {
+                    iter = k;
+                    break;
+                }
+
+                vec2 ri = ffMul(r, i);
+                i = ffAdd(ri + ri, y); // z = z^2 + c (doubling both parts is exact)
+                r = ffAdd(ffAdd(r2, -i2), x);
+            }
+
+            // If loop completed without breaking, we're in the set
+            if (iter == 0 && r2.x + i2.x < 4.0) {
+                iter = maxIter;
+            }
+
+            float rOut = mod(float(iter), 256.0) / 255.0;
+            float gOut = floor(float(iter) / 256.0) / 255.0;
+
+            fragColor = vec4(rOut, gOut, 0.0, 1.0);
+        }
+    )";
+
+    GLuint vs = compileShader(GL_VERTEX_SHADER, vsSource);
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, fsSource);
+    programId = linkProgram(vs, fs);
+
+    locOriginR = glGetUniformLocation(programId, "originR");
+    locOriginI = glGetUniformLocation(programId, "originI");
+    locStepR = glGetUniformLocation(programId, "stepR");
+    locStepI = glGetUniformLocation(programId, "stepI");
+    locMaxIter = glGetUniformLocation(programId, "maxIter");
+}
+
+bool GpuMandelbrotCalculator::computeSupported()
+{
+    GLint major = 0;
+    GLint minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    return major * 10 + minor >= 43;
+}
+
+void GpuMandelbrotCalculator::initComputeShaders()
+{
+    // One invocation per pixel, 16x16 per workgroup. A pass runs the
+    // iterations [firstIter, lastIter) of the band starting at row bandY;
+    // the first pass starts every pixel at z = c, the others resume the
+    // orbits left by the previous one. A workgroup whose pixels all
+    // finished in an earlier pass skips its pixels, but every invocation
+    // still reaches both barriers (barrier() may not follow a return in main).
+    // Same escape test and counts as the fragment shader, and the same
+    // pixel positions as the CPU engines (row 0 is minI).
+    const std::string csSourceTemplate = R"(
+        #version 430 core
+
+        layout(local_size_x = 16, local_size_y = 16) in;
+
+        layout(std430, binding = 0) buffer Counts { uint counts[]; };       // Whole frame
+        layout(std430, binding = 1) buffer Orbits { $PRECISION_TYPE orbits[]; }; // (r, i) per band pixel
+        layout(std430, binding = 2) buffer Groups { uint groupActive[]; };  // Per band workgroup
+
+        uniform double minR;
+        uniform double minI;
+        uniform double stepR;
+        uniform double stepI;
+        uniform ivec2 size;
+        uniform int bandY;
+        uniform int firstIter;
+        uniform int lastIter;
+        uniform int maxIter;
+
+        const uint FINAL = 0x80000000u;
+
+        shared bool anyActive;
+
+        void main() {
+            uint group = gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x;
+            bool running = firstIter == 0 || groupActive[group] != 0u; // "active" is reserved
+
+            if (gl_LocalInvocationIndex == 0u)
+                anyActive = false;
+            memoryBarrierShared();
+            barrier();
+
+            ivec2 p = ivec2(gl_GlobalInvocationID.xy) + ivec2(0, bandY);
+            if (running && p.x < size.x && p.y < size.y) {
+                uint index = uint(p.y * size.x + p.x);
+                uint orbit = 2u * uint((p.y - bandY) * size.x + p.x);
+
+                $PRECISION_TYPE x = $PRECISION_TYPE(minR + double(p.x) * stepR);
+                $PRECISION_TYPE y = $PRECISION_TYPE(minI + double(p.y) * stepI);
+
+                $PRECISION_TYPE r = x;
+                $PRECISION_TYPE i = y;
+                uint count = 0u;
+                if (firstIter > 0) {
+                    count = counts[index];
+                    r = orbits[orbit];
+                    i = orbits[orbit + 1u];
+                }
+
+                if ((count & FINAL) == 0u) {
+                    int k = firstIter;
+                    bool escaped = false;
+                    for (; k < lastIter; ++k) {
+                        $PRECISION_TYPE r2 = r * r;
+                        $PRECISION_TYPE i2 = i * i;
+                        if (r2 + i2 >= $PRECISION_TYPE(4.0)) {
+                            escaped = true;
+                            break;
+                        }
+                        $PRECISION_TYPE ri = r * i;
+                        i = ri + ri + y; // z = z^2 + c
+                        r = r2 - i2 + x;
+                    }
+
+                    if (escaped) {
+                        count = uint(k) | FINAL;
+                    } else if (k >= maxIter) {
+                        count = uint(maxIter) | FINAL;
+                    } else {
+                        count = uint(k);
+                        orbits[orbit] = r;
+                        orbits[orbit + 1u] = i;
+                        anyActive = true;
+                    }
+                    counts[index] = count;
+                }
+            }
+
+            memoryBarrierShared();
+            barrier();
+            if (gl_LocalInvocationIndex == 0u)
+                groupActive[group] = anyActive ? 1u : 0u;
+        }
+    )";
+
+    // Replace $PRECISION_TYPE with the actual type
+    const char *precisionType = (precision == Precision::FLOAT) ? "float" : "double";
+    std::string csSource = csSourceTemplate;
+    size_t pos = 0;
+    while ((pos = csSource.find("$PRECISION_TYPE", pos)) != std::string::npos)
+    {
+        csSource.replace(pos, 15, precisionType);
+        pos += strlen(precisionType);
+    }
+
+    GLuint cs = compileShader(GL_COMPUTE_SHADER, csSource);
+    programId = linkComputeProgram(cs);
+
+    locMinR = glGetUniformLocation(programId, "minR");
+    locMinI = glGetUniformLocation(programId, "minI");
+    locStepRd = glGetUniformLocation(programId, "stepR");
+    locStepId = glGetUniformLocation(programId, "stepI");
+    locSize = glGetUniformLocation(programId, "size");
+    locBandY = glGetUniformLocation(programId, "bandY");
+    locFirstIter = glGetUniformLocation(programId, "firstIter");
+    locLastIter = glGetUniformLocation(programId, "lastIter");
+    locMaxIter = glGetUniformLocation(programId, "maxIter");
+}
+
+void GpuMandelbrotCalculator::initColorShaders()
+{
+    if (pipeline == Pipeline::COMPUTE)
+    {
+        if (!programId)
+            return; // The compute shader did not build
+
+        // Display pass of the compute pipeline: counts straight from the
+        // storage buffer, whose row 0 is the top of the image
+        const std::string fsSource = R"(
+            #version 430 core
+
+            layout(std430, binding = 0) readonly buffer Counts { uint counts[]; };
+            uniform sampler2D palette;
+            uniform int width;
+
+            out vec4 fragColor;
+
+            void main() {
+                ivec2 p = ivec2(gl_FragCoord.xy);
+                int iter = int(counts[p.y * width + p.x] & 0xffffu);
+                fragColor = texelFetch(palette, ivec2(iter % 256, iter / 256), 0);
+            }
+        )";
+
+        GLuint vs = compileShader(GL_VERTEX_SHADER, vsSource);
+        GLuint fs = compileShader(GL_FRAGMENT_SHADER, fsSource);
+        colorProgramId = linkProgram(vs, fs);
+
+        locPalette = glGetUniformLocation(colorProgramId, "palette");
+        locWidth = glGetUniformLocation(colorProgramId, "width");
+        return;
+    }
+
+    // Fragment Shader for display: decodes the iteration count of the pixel
+    // from the iteration texture and looks its color up in the palette
+    // (256 entries per row). Target row 0 is the top of the image, which is
+    // the last row of the iteration texture.
+    const std::string fsSource = R"(
+        #version 400 core
+
+        uniform sampler2D iterations;
+        uniform sampler2D palette;
+        uniform int height;
+
+        out vec4 fragColor;
+
+        void main() {
+            ivec2 p = ivec2(gl_FragCoord.xy);
+            vec4 encoded = texelFetch(iterations, ivec2(p.x, height - 1 - p.y), 0);
+            int iter = int(encoded.r * 255.0 + 0.5) + 256 * int(encoded.g * 255.0 + 0.5);
+            fragColor = texelFetch(palette, ivec2(iter % 256, iter / 256), 0);
+        }
+    )";
+
+    GLuint vs = compileShader(GL_VERTEX_SHADER, vsSource);
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, fsSource);
+    colorProgramId = linkProgram(vs, fs);
+
+    locIterations = glGetUniformLocation(colorProgramId, "iterations");
+    locPalette = glGetUniformLocation(colorProgramId, "palette");
+    locHeight = glGetUniformLocation(colorProgramId, "height");
+}
+
+GLuint GpuMandelbrotCalculator::linkProgram(GLuint vs, GLuint fs)
+{
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vs);
+    glAttachShader(program, fs);
 
     // Bind attribute location before linking
-    glBindAttribLocation(programId, 0, "position");
+    glBindAttribLocation(program, 0, "position");
 
-    glLinkProgram(programId);
+    glLinkProgram(program);
 
     GLint linked;
-    glGetProgramiv(programId, GL_LINK_STATUS, &linked);
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
     if (!linked)
     {
         char log[512];
-        glGetProgramInfoLog(programId, 512, NULL, log);
+        glGetProgramInfoLog(program, 512, NULL, log);
         std::cerr << "Shader Linking Error: " << log << std::endl;
     }
 
     glDeleteShader(vs);
     glDeleteShader(fs);
+    return program;
+}
 
-    // Get uniform locations
-    locMinR = glGetUniformLocation(programId, "minR");
-    locMinI = glGetUniformLocation(programId, "minI");
-    locMaxR = glGetUniformLocation(programId, "maxR");
-    locMaxI = glGetUniformLocation(programId, "maxI");
-    locMaxIter = glGetUniformLocation(programId, "maxIter");
+GLuint GpuMandelbrotCalculator::linkComputeProgram(GLuint cs)
+{
+    GLuint program = glCreateProgram();
+    glAttachShader(program, cs);
+    glLinkProgram(program);
+
+    GLint linked;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked)
+    {
+        char log[512];
+        glGetProgramInfoLog(program, 512, NULL, log);
+        std::cerr << "Shader Linking Error: " << log << std::endl;
+    }
+
+    glDeleteShader(cs);
+    return program;
 }
 
 GLuint GpuMandelbrotCalculator::compileShader(GLenum type, const std::string &source)
@@ -300,7 +1036,7 @@ GLuint GpuMandelbrotCalculator::compileShader(GLenum type, const std::string &so
     {
         char log[512];
         glGetShaderInfoLog(shader, 512, NULL, log);
-        std::cerr << "Shader Compilation Error (" << (type == GL_VERTEX_SHADER ? "VS" : "FS") << "): " << log << std::endl;
+        std::cerr << "Shader Compilation Error (" << (type == GL_VERTEX_SHADER ? "VS" : type == GL_COMPUTE_SHADER ? "CS" : "FS") << "): " << log << std::endl;
     }
     return shader;
 }
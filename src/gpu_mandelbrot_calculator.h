@@ -14,28 +14,53 @@ public:
     enum class Precision
     {
         FLOAT,
-        DOUBLE
+        DOUBLE,
+        DOUBLE_FLOAT // Pairs of floats (hi + lo): no fp64 needed, ~48 bits
     };
 
-    GpuMandelbrotCalculator(int width, int height, Precision precision = Precision::FLOAT);
+    enum class Pipeline
+    {
+        FRAGMENT, // Whole frame in one fullscreen draw, counts packed in RGBA8
+        COMPUTE   // OpenGL 4.3 compute shader: bands of rows in bounded passes,
+                  // 32-bit counts in a storage buffer (FLOAT or DOUBLE only)
+    };
+
+    // A COMPUTE pipeline falls back to FRAGMENT when the context is older than 4.3
+    GpuMandelbrotCalculator(int width, int height, Precision precision = Precision::FLOAT,
+                            Pipeline pipeline = Pipeline::FRAGMENT);
     ~GpuMandelbrotCalculator();
 
+    // Whether the current context has compute shaders (OpenGL 4.3)
+    static bool computeSupported();
+
     void compute(std::function<void()> progressCallback) override;
     void reset() override;
 
-    // GPU implementation now returns data to CPU
-    const std::vector<int> &getData() const override { return data; }
+    // Iterations are read back from the GPU on first access after compute,
+    // so frames that are only displayed never leave the GPU
+    const std::vector<IterationCount> &getData() const override;
+
+    // Draw time comes from a GPU timer query, read back time from getData()
+    const CalculatorStats &getStats() const override;
 
-    // No longer has own output, behaves like standard calculator
-    bool hasOwnOutput() const override { return false; }
+    // The frame can be colorized on the GPU, straight into a display texture
+    bool hasOwnOutput() const override { return true; }
+    void setPalette(const std::vector<uint32_t> &palette) override;
+    void render(unsigned targetTexture) override;
     
     std::string getEngineName() const override { 
+        if (pipeline == Pipeline::COMPUTE)
+            return " gpuc";
+        if (precision == Precision::DOUBLE_FLOAT)
+            return " gpuff";
         return (precision == Precision::FLOAT) ? " gpuf" : " gpud"; 
     }
 
 private:
-    std::vector<int> data;
+    mutable std::vector<IterationCount> data;
+    mutable bool dataStale; // The FBO holds a frame not read back yet
     Precision precision;
+    Pipeline pipeline;
 
     GLuint programId;
     GLuint vao;
@@ -43,12 +68,62 @@ private:
     GLuint fbo;
     GLuint texture;
 
+    // Asynchronous readback: the frame is read in strips, alternating two
+    // pixel buffer objects. While a strip is transferred the previous one is
+    // decoded straight from its mapped buffer.
+    static constexpr int READBACK_STRIPS = 4;
+    GLuint pbo[2];
+    int stripHeight;
+
+    // Compute pipeline: the frame is computed in bands of bandRows rows
+    // (about BAND_PIXELS pixels), each in passes of at most
+    // ITERATIONS_PER_PASS iterations, so no single dispatch runs long enough
+    // to trip a GPU watchdog. Pixels still iterating keep their z in
+    // orbitBuffer between passes; groupBuffer flags the workgroups of the
+    // band that have any, the others return at once. Each band is copied to
+    // readbackBuffer[k % 2] and decoded while the next one computes.
+    static constexpr int BAND_PIXELS = 1 << 18;
+    static constexpr int ITERATIONS_PER_PASS = 1024;
+    static constexpr int WORKGROUP_SIZE = 16; // local_size_x and _y
+    GLuint countBuffer;  // One uint per pixel: count, top bit set once final
+    GLuint orbitBuffer;  // z = (r, i) per pixel of a band
+    GLuint groupBuffer;  // One uint per workgroup of a band
+    GLuint readbackBuffer[2];
+    int bandRows;
+
+    // Display pass: iteration texture -> palette lookup -> target texture
+    GLuint colorProgramId;
+    GLuint displayFbo;
+    GLuint displayTarget; // Texture attached to displayFbo
+    GLuint paletteTexture;
+    std::vector<uint32_t> palette; // Last uploaded palette (ARGB, indexed by iteration)
+    bool paletteDirty;
+    GLint locIterations, locPalette, locHeight;
+
+    // GL_TIME_ELAPSED query around the draw, read by getStats()
+    GLuint timerQuery;
+    mutable bool timerPending;
+
     // Shader uniforms
     GLint locMinR, locMinI, locMaxR, locMaxI;
+    GLint locOriginR, locOriginI, locStepR, locStepI; // DOUBLE_FLOAT, as (hi, lo) float pairs
     GLint locMaxIter;
+    GLint locSize, locBandY, locFirstIter, locLastIter, locStepRd, locStepId; // COMPUTE
+    GLint locWidth; // COMPUTE display pass
 
     void initShaders();
+    void initDoubleFloatShaders();
+    void initComputeShaders();
+    void initComputeBuffers();
+    void computeBands(const std::function<void()> &progressCallback);
+    void decodeBand(const uint32_t *counts, int y0, int rows);
     void initGeometry();
     void initFBO();
+    void initPBO();
+    void initColorShaders();
+    void readback() const;
+    void decodeStrip(const uint8_t *pixels, int glY, int rows) const;
     GLuint compileShader(GLenum type, const std::string &source);
+    GLuint linkProgram(GLuint vs, GLuint fs);
+    GLuint linkComputeProgram(GLuint cs);
 };
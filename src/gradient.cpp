@@ -37,6 +37,28 @@ std::unique_ptr<Gradient> Gradient::createRandom()
     return baseGradient;
 }
 
+void Gradient::bakePalette(int maxIter, std::vector<uint32_t> &palette) const
+{
+    palette.resize(maxIter + 1);
+    for (int iter = 0; iter < maxIter; ++iter)
+    {
+        double t = static_cast<double>(iter) / maxIter;
+        SDL_Color color = getColor(t);
+
+        if (iter % 2 != 0)
+        {
+            // Shift value (brightness) for odd iterations
+            const int shift = 34;
+            color.r = std::min(255, color.r + shift);
+            color.g = std::min(255, color.g + shift);
+            color.b = std::min(255, color.b + shift);
+        }
+        // ARGB8888: A R G B
+        palette[iter] = (0xFFu << 24) | (color.r << 16) | (color.g << 8) | color.b;
+    }
+    palette[maxIter] = 0xFF000000; // Black (Alpha=255)
+}
+
 CosineGradient::CosineGradient(int base, int amplitude, double freqR, double freqG, double freqB)
     : base(base), amplitude(amplitude), freqR(freqR), freqG(freqG), freqB(freqB)
 {
@@ -2,7 +2,9 @@
 #define GRADIENT_H
 
 #include <SDL2/SDL.h>
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 /**
  * Abstract base class for gradients.
@@ -25,6 +27,13 @@ public:
      * @return A unique pointer to a randomly generated gradient
      */
     static std::unique_ptr<Gradient> createRandom();
+
+    /**
+     * Bake the colors of a frame: one ARGB8888 color per iteration count
+     * (0..maxIter). Odd counts are brightened so bands stay visible, and
+     * maxIter (interior) is black.
+     */
+    void bakePalette(int maxIter, std::vector<uint32_t> &palette) const;
 };
 
 /**
@@ -1,17 +1,30 @@
 #include "grid_mandelbrot_calculator.h"
 #include "simd_mandelbrot_calculator.h"
 #include "gpu_mandelbrot_calculator.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <format>
-#include <thread>
+#include <mutex>
+#include <numeric>
 #include <vector>
 
 GridMandelbrotCalculator::GridMandelbrotCalculator(int w, int h, int rows, int cols)
-    : StorageMandelbrotCalculator(w, h), gridRows(rows), gridCols(cols), engineType(EngineType::BORDER)
+    : StorageMandelbrotCalculator(w, h), gridRows(rows), gridCols(cols), engineType(EngineType::BORDER), tilesShareOutput(false),
+      gpuRate(0.0), cpuRate(0.0), seededFrame(false),
+      deltaMinR(0.0), deltaMinI(0.0), deltaStepR(0.0), deltaStepI(0.0)
 {
     tileInfos.resize(gridRows * gridCols);
+    tileCost.assign(gridRows * gridCols, 0.0);
+    tileOrder.resize(gridRows * gridCols);
+    tileCached.assign(gridRows * gridCols, 0);
+    std::iota(tileOrder.begin(), tileOrder.end(), 0);
 
-    // Create tile calculators (we'll set their dimensions after calculating geometry)
-    tiles.reserve(gridRows * gridCols);
+    // Pixel geometry only depends on the grid and image size, so the tile
+    // calculators are created once and then kept across view changes
+    calculateTileGeometry();
+    createTiles();
 
     // Default initialization
     updateBounds(-0.5, 0.0, 3.0);
@@ -38,35 +51,32 @@ void GridMandelbrotCalculator::calculateTileGeometry()
 
             tile.width = endX - tile.startX;
             tile.height = endY - tile.startY;
-
-            // Calculate complex plane bounds for this tile
-            tile.minR = minr + tile.startX * stepr;
-            tile.minI = mini + tile.startY * stepi;
-            tile.maxR = minr + endX * stepr;
-            tile.maxI = mini + endY * stepi;
         }
     }
 }
 
-void GridMandelbrotCalculator::updateBounds(double new_cre, double new_cim, double new_diam)
+void GridMandelbrotCalculator::createTiles()
 {
-    ZoomMandelbrotCalculator::updateBounds(new_cre, new_cim, new_diam);
-
-    // Calculate geometry for all tiles
-    calculateTileGeometry();
-
-    // (Re)create tile calculators with correct dimensions
+    // (Re)create tile calculators for the current engine type.
+    // Only needed when the engine type changes: view changes just re-push bounds.
     tiles.clear();
+    gpuTile.reset();
+    tileOnGpu.assign(gridRows * gridCols, 0);
+    gpuRate = cpuRate = 0.0;
     for (int i = 0; i < gridRows * gridCols; ++i)
     {
         const TileInfo &tile = tileInfos[i];
         std::unique_ptr<MandelbrotCalculator> calculator;
 
-        if (engineType == EngineType::STANDARD)
+        if (engineType == EngineType::BORDER_SIMD)
+        {
+            calculator = std::make_unique<BorderMandelbrotCalculator>(tile.width, tile.height, true);
+        }
+        else if (engineType == EngineType::STANDARD)
         {
             calculator = std::make_unique<StandardMandelbrotCalculator>(tile.width, tile.height);
         }
-        else if (engineType == EngineType::SIMD)
+        else if (engineType == EngineType::SIMD || engineType == EngineType::PERTURB_SIMD || engineType == EngineType::HYBRID)
         {
             calculator = std::make_unique<SimdMandelbrotCalculator>(tile.width, tile.height);
         }
@@ -84,71 +94,155 @@ void GridMandelbrotCalculator::updateBounds(double new_cre, double new_cim, doub
         {
             calculator = std::make_unique<GpuMandelbrotCalculator>(tile.width, tile.height, GpuMandelbrotCalculator::Precision::DOUBLE);
         }
+        else if (engineType == EngineType::GPUFF)
+        {
+            calculator = std::make_unique<GpuMandelbrotCalculator>(tile.width, tile.height, GpuMandelbrotCalculator::Precision::DOUBLE_FLOAT);
+        }
+        else if (engineType == EngineType::GPUC)
+        {
+            calculator = std::make_unique<GpuMandelbrotCalculator>(tile.width, tile.height, GpuMandelbrotCalculator::Precision::DOUBLE,
+                                                                   GpuMandelbrotCalculator::Pipeline::COMPUTE);
+        }
         else
         {
             calculator = std::make_unique<BorderMandelbrotCalculator>(tile.width, tile.height);
         }
 
-        // Set explicit bounds for this tile (no aspect ratio adjustment)
-        calculator->updateBoundsExplicit(tile.minR, tile.minI, tile.maxR, tile.maxI);
         calculator->setSpeedMode(speedMode);
+        calculator->setInteriorCheck(interiorCheck);
+        calculator->setMaxIterations(maxIter);
+        calculator->setCancelFlag(cancelFlag);
+        if (isPerturbationEngine(engineType))
+            calculator->setPointKernel([this](const double *cr, const double *ci, IterationCount *values, int count, int limit)
+                                       { orbit.iterate(cr, ci, values, count, limit); });
 
         tiles.push_back(std::move(calculator));
     }
+
+    attachTiles();
 }
 
-void GridMandelbrotCalculator::updateBoundsExplicit(double new_minr, double new_mini, double new_maxr, double new_maxi)
+void GridMandelbrotCalculator::attachTiles()
 {
-    ZoomMandelbrotCalculator::updateBoundsExplicit(new_minr, new_mini, new_maxr, new_maxi);
+    // Point each tile at its rectangle of the grid output. Engines that keep
+    // their own buffer (GPU) are composited instead.
+    tilesShareOutput = !tiles.empty();
+    for (int i = 0; i < static_cast<int>(tiles.size()); ++i)
+    {
+        const TileInfo &tile = tileInfos[i];
+        if (!tiles[i]->setOutput(out + tile.startY * pitch + tile.startX, pitch))
+            tilesShareOutput = false;
+    }
+}
 
-    // Calculate geometry for all tiles
-    calculateTileGeometry();
+bool GridMandelbrotCalculator::setOutput(IterationCount *base, int newPitch)
+{
+    StorageMandelbrotCalculator::setOutput(base, newPitch);
+    attachTiles();
+    return true;
+}
+
+void GridMandelbrotCalculator::updateTileBounds()
+{
+    // Perturbation tiles are placed relative to the center
+    bool perturbation = isPerturbationEngine(engineType);
+    double originR = perturbation ? deltaMinR : minr;
+    double originI = perturbation ? deltaMinI : mini;
+    double stepR = perturbation ? deltaStepR : stepr;
+    double stepI = perturbation ? deltaStepI : stepi;
 
-    // (Re)create tile calculators with correct dimensions
-    tiles.clear();
     for (int i = 0; i < gridRows * gridCols; ++i)
     {
-        const TileInfo &tile = tileInfos[i];
-        std::unique_ptr<MandelbrotCalculator> calculator;
+        TileInfo &tile = tileInfos[i];
 
-        if (engineType == EngineType::STANDARD)
-        {
-            calculator = std::make_unique<StandardMandelbrotCalculator>(tile.width, tile.height);
-        }
-        else if (engineType == EngineType::SIMD)
-        {
-            calculator = std::make_unique<SimdMandelbrotCalculator>(tile.width, tile.height);
-        }
-        else if (engineType == EngineType::GPUF)
-        {
-            calculator = std::make_unique<GpuMandelbrotCalculator>(tile.width, tile.height, GpuMandelbrotCalculator::Precision::FLOAT);
-        }
-        else if (engineType == EngineType::GPUD)
-        {
-            calculator = std::make_unique<GpuMandelbrotCalculator>(tile.width, tile.height, GpuMandelbrotCalculator::Precision::DOUBLE);
-        }
-        else
-        {
-            calculator = std::make_unique<BorderMandelbrotCalculator>(tile.width, tile.height);
-        }
+        // Calculate complex plane bounds for this tile
+        tile.minR = originR + tile.startX * stepR;
+        tile.minI = originI + tile.startY * stepI;
+        tile.maxR = originR + (tile.startX + tile.width) * stepR;
+        tile.maxI = originI + (tile.startY + tile.height) * stepI;
 
         // Set explicit bounds for this tile (no aspect ratio adjustment)
-        calculator->updateBoundsExplicit(tile.minR, tile.minI, tile.maxR, tile.maxI);
-        calculator->setSpeedMode(speedMode);
-
-        tiles.push_back(std::move(calculator));
+        tiles[i]->updateBoundsExplicit(tile.minR, tile.minI, tile.maxR, tile.maxI);
     }
 }
 
+void GridMandelbrotCalculator::updateBounds(double new_cre, double new_cim, double new_diam)
+{
+    ZoomMandelbrotCalculator::updateBounds(new_cre, new_cim, new_diam);
+    preciseCre = BigFloat(new_cre, BigFloat::limbsFor(new_diam));
+    preciseCim = BigFloat(new_cim, BigFloat::limbsFor(new_diam));
+    updateDeltaBounds();
+    updateTileBounds();
+}
+
+void GridMandelbrotCalculator::updateBoundsPrecise(const BigFloat &new_cre, const BigFloat &new_cim, double new_diam)
+{
+    ZoomMandelbrotCalculator::updateBounds(new_cre.toDouble(), new_cim.toDouble(), new_diam);
+    preciseCre = new_cre;
+    preciseCim = new_cim;
+    updateDeltaBounds();
+    updateTileBounds();
+}
+
+void GridMandelbrotCalculator::updateDeltaBounds()
+{
+    // Same rectangle as updateBounds(), from the diameter only
+    deltaMinR = -diam * 0.5 * width / height;
+    deltaMinI = -diam * 0.5;
+    deltaStepR = -2.0 * deltaMinR / width;
+    deltaStepI = -2.0 * deltaMinI / height;
+}
+
+void GridMandelbrotCalculator::updateBoundsExplicit(double new_minr, double new_mini, double new_maxr, double new_maxi)
+{
+    ZoomMandelbrotCalculator::updateBoundsExplicit(new_minr, new_mini, new_maxr, new_maxi);
+    preciseCre = BigFloat(cre, BigFloat::limbsFor(diam));
+    preciseCim = BigFloat(cim, BigFloat::limbsFor(diam));
+    deltaMinR = minr - cre;
+    deltaMinI = mini - cim;
+    deltaStepR = stepr;
+    deltaStepI = stepi;
+    updateTileBounds();
+}
+
+double GridMandelbrotCalculator::getMinDiam() const
+{
+    // Offsets stay normal doubles down to about 1e-300 (pixels are ~1000 times
+    // smaller than the view)
+    if (isPerturbationEngine(engineType))
+        return 1e-290;
+    // Float-float resolves ~48 bits: ~7e-15 near |c| = 2, and the ~1000
+    // pixels of a view must be several of those apart
+    if (engineType == EngineType::GPUFF)
+        return 1e-11;
+    return ZoomMandelbrotCalculator::getMinDiam();
+}
+
 void GridMandelbrotCalculator::reset()
 {
-    StorageMandelbrotCalculator::reset();
+    // Shared output: the tiles clear their own rectangles
+    if (!tilesShareOutput)
+        StorageMandelbrotCalculator::reset();
     for (auto &tile : tiles)
     {
         tile->reset();
     }
 }
 
+void GridMandelbrotCalculator::seed(const FrameSnapshot &previous)
+{
+    // Snapshots place pixels in absolute doubles, which a deep view has not
+    if (isPerturbationEngine(engineType))
+        return;
+
+    // Each tile maps the previous frame onto its own samples
+    for (auto &tile : tiles)
+    {
+        tile->seed(previous);
+    }
+    seededFrame = true;
+}
+
 void GridMandelbrotCalculator::setSpeedMode(bool mode)
 {
     ZoomMandelbrotCalculator::setSpeedMode(mode);
@@ -158,169 +252,433 @@ void GridMandelbrotCalculator::setSpeedMode(bool mode)
     }
 }
 
-void GridMandelbrotCalculator::compositeData()
+void GridMandelbrotCalculator::setInteriorCheck(bool enabled)
 {
-    // Copy data from all tiles into the unified buffer
-    for (int tileIdx = 0; tileIdx < gridRows * gridCols; ++tileIdx)
+    ZoomMandelbrotCalculator::setInteriorCheck(enabled);
+    for (auto &tile : tiles)
     {
-        const TileInfo &tile = tileInfos[tileIdx];
-        const auto &tileData = tiles[tileIdx]->getData();
+        tile->setInteriorCheck(enabled);
+    }
+}
 
-        // Copy each row of the tile into the unified buffer
-        for (int y = 0; y < tile.height; ++y)
-        {
-            int srcOffset = y * tile.width;
-            int dstOffset = (tile.startY + y) * width + tile.startX;
+void GridMandelbrotCalculator::setMaxIterations(int newMaxIter)
+{
+    ZoomMandelbrotCalculator::setMaxIterations(newMaxIter);
+    for (auto &tile : tiles)
+    {
+        tile->setMaxIterations(maxIter);
+    }
+    if (gpuTile)
+        gpuTile->setMaxIterations(maxIter);
+}
 
-            for (int x = 0; x < tile.width; ++x)
-            {
-                data[dstOffset + x] = tileData[srcOffset + x];
-            }
-        }
+void GridMandelbrotCalculator::setCancelFlag(const std::atomic<bool> *flag)
+{
+    ZoomMandelbrotCalculator::setCancelFlag(flag);
+    for (auto &tile : tiles)
+    {
+        tile->setCancelFlag(flag);
     }
+    if (gpuTile)
+        gpuTile->setCancelFlag(flag);
+}
+
+void GridMandelbrotCalculator::compositeTile(int tileIdx)
+{
+    // Hybrid tiles computed on the GPU are always copied
+    bool onGpu = tileOnGpu[tileIdx];
+    if (tilesShareOutput && !onGpu)
+        return;
+
+    // Copy each row of the tile into the unified buffer
+    const TileInfo &tile = tileInfos[tileIdx];
+    const MandelbrotCalculator &source = onGpu ? *gpuTile : *tiles[tileIdx];
+    const auto &tileData = source.getData();
+    const int tilePitch = source.getWidth();
+
+    for (int y = 0; y < tile.height; ++y)
+        storeCounts(&at(tile.startX, tile.startY + y), &tileData[y * tilePitch], tile.width);
 }
 
 void GridMandelbrotCalculator::compute(std::function<void()> progressCallback)
 {
-    unsigned long long totalComposites = 0; // Track how many times we composite
+    // One reference orbit (and series) serves every tile
+    if (isPerturbationEngine(engineType))
+    {
+        if (!orbit.compute(preciseCre, preciseCim, diam, maxIter, cancelFlag))
+            return;
+        orbit.approximate(std::max(std::fabs(deltaMinR), std::fabs(deltaMinR + width * deltaStepR)),
+                          std::max(std::fabs(deltaMinI), std::fabs(deltaMinI + height * deltaStepI)));
+    }
+
+    if (isPassThrough())
+    {
+        tiles[0]->compute(progressCallback);
+        return;
+    }
+
+    std::fill(tileOnGpu.begin(), tileOnGpu.end(), 0);
+    gpuStats.clear();
+    lookupCachedTiles();
+    seededFrame = false;
+    if (speedMode && engineType == EngineType::HYBRID && tiles.size() > 1)
+    {
+        computeHybrid(progressCallback);
+        return;
+    }
 
     // GPU engine must run on the main thread (where the GL context is current)
     // So we force sequential mode for GPU.
-    if (speedMode && engineType != EngineType::GPUF && engineType != EngineType::GPUD)
+    if (speedMode && !isGpuEngine(engineType))
     {
-        // PARALLEL MODE: Compute all tiles in parallel using threads
+        // PARALLEL MODE: Workers from the shared pool pull tiles one at a time,
+        // so a thread that draws cheap (escaping) tiles keeps taking more while
+        // another is stuck on an interior-heavy one.
         const int numTiles = gridRows * gridCols;
-        const unsigned int numThreads = std::thread::hardware_concurrency();
-
-        // Lambda to process a range of tiles
-        auto processTiles = [this](int startIdx, int endIdx)
+        auto start = std::chrono::steady_clock::now();
+
+        // Hand out the tiles that were most expensive last frame first, so the
+        // long ones do not end up starting last
+        std::stable_sort(tileOrder.begin(), tileOrder.end(), [this](int a, int b)
+                         { return tileCost[a] > tileCost[b]; });
+
+        ThreadPool::instance().parallelFor(numTiles, [this](int i)
+                                           {
+            int tileIdx = tileOrder[i];
+            if (isCancelled() || tileCached[tileIdx])
+                return;
+            auto tileStart = std::chrono::steady_clock::now();
+            tiles[tileIdx]->compute(nullptr);
+            auto tileEnd = std::chrono::steady_clock::now();
+            tileCost[tileIdx] = std::chrono::duration<double>(tileEnd - tileStart).count();
+            compositeTile(tileIdx);
+            storeTile(tileIdx); });
+
+        // Thread time not spent in a tile: waiting for the last tiles, and
+        // threads that found none left
+        ThreadPool &pool = ThreadPool::instance();
+        double threads = ThreadPool::isInsideJob() ? 1.0 : pool.getThreadCount();
+        double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double busy = std::accumulate(tileCost.begin(), tileCost.end(), 0.0);
+        collectStats(std::max(0.0, threads * wall - busy) * 1000.0);
+    }
+    else
+    {
+        // SEQUENTIAL MODE: Compute tiles one at a time with progressive rendering.
+        // Tiles draw straight into the grid output, so the progress callback
+        // can render without any compositing.
+        for (int tileIdx = 0; tileIdx < gridRows * gridCols && !isCancelled(); ++tileIdx)
         {
-            for (int tileIdx = startIdx; tileIdx < endIdx; ++tileIdx)
-            {
-                tiles[tileIdx]->compute(nullptr);
-            }
-        };
+            if (tileCached[tileIdx])
+                continue;
 
-        // Create threads and distribute tiles among them
-        std::vector<std::thread> threads;
-        int tilesPerThread = (numTiles + numThreads - 1) / numThreads; // Ceiling division
-
-        for (unsigned int t = 0; t < numThreads; ++t)
-        {
-            int startIdx = t * tilesPerThread;
-            int endIdx = std::min(startIdx + tilesPerThread, numTiles);
+            auto tileStart = std::chrono::steady_clock::now();
+            tiles[tileIdx]->compute([this, tileIdx, progressCallback]()
+                                    {
+                compositeTile(tileIdx);
+                if (progressCallback)
+                    progressCallback(); });
+            tileCost[tileIdx] = std::chrono::duration<double>(std::chrono::steady_clock::now() - tileStart).count();
 
-            if (startIdx < numTiles)
+            // Render the final tile state
+            compositeTile(tileIdx);
+            storeTile(tileIdx);
+            if (progressCallback)
             {
-                threads.emplace_back(processTiles, startIdx, endIdx);
+                progressCallback();
             }
         }
+        collectStats(0.0);
+    }
+}
 
-        // Wait for all threads to complete
-        for (auto &thread : threads)
+void GridMandelbrotCalculator::computeHybrid(const std::function<void()> &progressCallback)
+{
+    // One queue of tiles, most expensive last frame first. The calling
+    // thread (where the GL context is current) takes chunks from the front
+    // for the GPU, the pool workers take single tiles from the back for the
+    // CPU, until they meet. Chunks are guided by the throughput measured on
+    // the last frame: half of the GPU's share of the pixels left, so the
+    // GPU gets large batches early and the two sides finish together.
+    const int numTiles = gridRows * gridCols;
+    auto start = std::chrono::steady_clock::now();
+
+    // Doubles and the same escape test on both sides, so a tile looks the
+    // same (up to rounding) whichever computes it
+    if (!gpuTile)
+    {
+        int gpuWidth = 0;
+        int gpuHeight = 0;
+        for (const TileInfo &tile : tileInfos)
         {
-            thread.join();
+            gpuWidth = std::max(gpuWidth, tile.width);
+            gpuHeight = std::max(gpuHeight, tile.height);
         }
+        gpuTile = std::make_unique<GpuMandelbrotCalculator>(gpuWidth, gpuHeight, GpuMandelbrotCalculator::Precision::DOUBLE);
+        gpuTile->setMaxIterations(maxIter);
+        gpuTile->setCancelFlag(cancelFlag);
     }
-    else
+
+    std::stable_sort(tileOrder.begin(), tileOrder.end(), [this](int a, int b)
+                     { return tileCost[a] > tileCost[b]; });
+
+    double gpuShare = (gpuRate > 0.0 && cpuRate > 0.0) ? gpuRate / (gpuRate + cpuRate) : 0.5;
+    auto pixelsOf = [this](int tileIdx)
+    { return static_cast<double>(tileInfos[tileIdx].width) * tileInfos[tileIdx].height; };
+
+    std::vector<int> queue;
+    for (int tileIdx : tileOrder)
+        if (!tileCached[tileIdx])
+            queue.push_back(tileIdx);
+
+    std::mutex queueMutex;
+    int front = 0;
+    int back = static_cast<int>(queue.size()); // Tiles queue[front..back) are left
+    double gpuSeconds = 0.0;
+    double gpuPixels = 0.0;
+    int gpuCount = 0;
+
+    auto gpuTask = [&]()
     {
-        // SEQUENTIAL MODE: Compute tiles one at a time with progressive rendering
-        for (int tileIdx = 0; tileIdx < gridRows * gridCols; ++tileIdx)
+        std::vector<int> chunk;
+        while (!isCancelled())
         {
-            // Normal mode: compute with progress callback that composites only this tile and renders
-            tiles[tileIdx]->compute([this, tileIdx, progressCallback, &totalComposites]()
-                                    {
-                // Composite only the current tile's data (not all tiles)
-                const TileInfo &tile = tileInfos[tileIdx];
-                const auto &tileData = tiles[tileIdx]->getData();
-                
-                for (int y = 0; y < tile.height; ++y)
-                {
-                    int srcOffset = y * tile.width;
-                    int dstOffset = (tile.startY + y) * width + tile.startX;
-                    
-                    for (int x = 0; x < tile.width; ++x)
-                    {
-                        data[dstOffset + x] = tileData[srcOffset + x];
-                    }
-                }
-                
-                totalComposites++;
-                
-                // Trigger the render callback
-                if (progressCallback)
-                {
-                    progressCallback();
-                } });
-
-            // After tile completes, composite its final state and render once more
-            const TileInfo &tile = tileInfos[tileIdx];
-            const auto &tileData = tiles[tileIdx]->getData();
-            
-            for (int y = 0; y < tile.height; ++y)
+            chunk.clear();
             {
-                int srcOffset = y * tile.width;
-                int dstOffset = (tile.startY + y) * width + tile.startX;
-                
-                for (int x = 0; x < tile.width; ++x)
+                std::lock_guard<std::mutex> lock(queueMutex);
+                double left = 0.0;
+                for (int k = front; k < back; ++k)
+                    left += pixelsOf(queue[k]);
+                double target = left * gpuShare * 0.5;
+                double taken = 0.0;
+                while (front < back && (chunk.empty() || taken < target))
                 {
-                    data[dstOffset + x] = tileData[srcOffset + x];
+                    chunk.push_back(queue[front++]);
+                    taken += pixelsOf(chunk.back());
                 }
             }
-            
-            totalComposites++;
-            
-            // Render the final tile state
-            if (progressCallback)
+            if (chunk.empty())
+                break;
+
+            // Each tile is drawn and read back before the GPU calculator
+            // moves on to the next. Its bounds keep the step of the grid from
+            // the tile's corner, half a pixel off: the shader samples pixel
+            // centers, the CPU engines pixel corners.
+            auto chunkStart = std::chrono::steady_clock::now();
+            double chunkPixels = 0.0;
+            for (int tileIdx : chunk)
             {
-                progressCallback();
+                const TileInfo &tile = tileInfos[tileIdx];
+                double originR = tile.minR - 0.5 * stepr;
+                double originI = tile.minI - 0.5 * stepi;
+                gpuTile->updateBoundsExplicit(originR, originI, originR + gpuTile->getWidth() * stepr,
+                                              originI + gpuTile->getHeight() * stepi);
+                gpuTile->compute(nullptr);
+                tileOnGpu[tileIdx] = 1;
+                compositeTile(tileIdx);
+                gpuStats.add(gpuTile->getStats());
+                chunkPixels += pixelsOf(tileIdx);
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - chunkStart).count();
+            for (int tileIdx : chunk)
+            {
+                tileCost[tileIdx] = seconds * pixelsOf(tileIdx) / chunkPixels;
+                storeTile(tileIdx);
             }
+            gpuSeconds += seconds;
+            gpuPixels += chunkPixels;
+            gpuCount += static_cast<int>(chunk.size());
 
+            // On the calling thread, so the frame can be shown as it fills
+            if (progressCallback)
+                progressCallback();
+        }
+    };
+
+    // Summed by the tiles the CPU computes this frame (a cancelled frame
+    // leaves the costs of tiles it never reached from earlier frames)
+    std::atomic<double> cpuPixels(0.0);
+    std::atomic<double> cpuSeconds(0.0);
+    ThreadPool::instance().parallelFor(numTiles, [&](int)
+                                       {
+        if (isCancelled())
+            return;
+        int tileIdx;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (front >= back)
+                return;
+            tileIdx = queue[--back];
+        }
+        auto tileStart = std::chrono::steady_clock::now();
+        tiles[tileIdx]->compute(nullptr);
+        tileCost[tileIdx] = std::chrono::duration<double>(std::chrono::steady_clock::now() - tileStart).count();
+        compositeTile(tileIdx);
+        storeTile(tileIdx);
+        cpuPixels.fetch_add(pixelsOf(tileIdx), std::memory_order_relaxed);
+        cpuSeconds.fetch_add(tileCost[tileIdx], std::memory_order_relaxed); }, gpuTask);
+
+    // Sides that computed nothing (cancelled frame, or the other side took
+    // everything) keep their last rate
+    ThreadPool &pool = ThreadPool::instance();
+    double workers = std::max(1.0, pool.getThreadCount() - 1.0);
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double cpuBusy = cpuSeconds.load();
+    if (gpuSeconds > 0.0)
+        gpuRate = gpuPixels / gpuSeconds;
+    if (cpuBusy > 0.0)
+        cpuRate = cpuPixels.load() / cpuBusy * workers;
+
+    collectStats(std::max(0.0, workers * wall - cpuBusy) * 1000.0);
+    stats.gpuTiles = gpuCount;
+}
+
+TileCache::Key GridMandelbrotCalculator::tileKey(int tileIdx) const
+{
+    const TileInfo &tile = tileInfos[tileIdx];
+    return TileCache::Key{tile.minR, tile.minI, stepr, stepi, tile.width, tile.height, maxIter, static_cast<int>(engineType)};
+}
+
+void GridMandelbrotCalculator::lookupCachedTiles()
+{
+    // Only tiles sampled at absolute doubles are cached (perturbation tiles
+    // are offsets from a center that is not part of the key). A seeded frame
+    // computes every tile, or tiles would keep a seed of another view.
+    std::fill(tileCached.begin(), tileCached.end(), 0);
+    TileCache &cache = TileCache::instance();
+    if (!cache.isEnabled() || isPerturbationEngine(engineType) || seededFrame)
+        return;
+
+    for (int i = 0; i < gridRows * gridCols; ++i)
+    {
+        const TileInfo &tile = tileInfos[i];
+        if (cache.lookup(tileKey(i), &at(tile.startX, tile.startY), pitch))
+        {
+            tileCached[i] = 1;
+            tileCost[i] = 0.0;
         }
     }
+}
 
-    // In speed mode, composite all tiles once at the end
-    if (speedMode)
+void GridMandelbrotCalculator::storeTile(int tileIdx)
+{
+    // A cancelled tile may be incomplete
+    TileCache &cache = TileCache::instance();
+    if (!cache.isEnabled() || isPerturbationEngine(engineType) || isCancelled())
+        return;
+
+    const TileInfo &tile = tileInfos[tileIdx];
+    cache.store(tileKey(tileIdx), &at(tile.startX, tile.startY), pitch);
+}
+
+void GridMandelbrotCalculator::collectStats(double idleMs)
+{
+    // Tiles read back (GPU) when composited, so their stats are complete.
+    // The hybrid GPU calculator also iterates past the edges of the smaller
+    // tiles: the pixels of its tiles are counted from the output, only its
+    // times are kept.
+    stats.clear();
+    for (size_t i = 0; i < tiles.size(); ++i)
     {
-        for (int tileIdx = 0; tileIdx < gridRows * gridCols; ++tileIdx)
+        if (!tileCached[i] && !tileOnGpu[i])
         {
-            const TileInfo &tile = tileInfos[tileIdx];
-            const auto &tileData = tiles[tileIdx]->getData();
+            stats.add(tiles[i]->getStats());
+            continue;
+        }
 
-            for (int y = 0; y < tile.height; ++y)
+        const TileInfo &tile = tileInfos[i];
+        for (int y = 0; y < tile.height; ++y)
+            for (int x = 0; x < tile.width; ++x)
             {
-                int srcOffset = y * tile.width;
-                int dstOffset = (tile.startY + y) * width + tile.startX;
-
-                for (int x = 0; x < tile.width; ++x)
-                {
-                    data[dstOffset + x] = tileData[srcOffset + x];
-                }
+                if (tileOnGpu[i])
+                    stats.countIterated(at(tile.startX + x, tile.startY + y), maxIter);
+                else
+                    stats.countReused(at(tile.startX + x, tile.startY + y), maxIter);
             }
-        }
-        totalComposites = 1; // Only one composite at the end
+        if (tileCached[i])
+            ++stats.cachedTiles;
+    }
+    stats.gpuDrawMs += gpuStats.gpuDrawMs;
+    stats.gpuReadbackMs += gpuStats.gpuReadbackMs;
+    stats.tileMs.resize(tileCost.size());
+    for (size_t i = 0; i < tileCost.size(); ++i)
+        stats.tileMs[i] = tileCost[i] * 1000.0;
+    stats.idleMs = idleMs;
+    if (isPerturbationEngine(engineType))
+    {
+        stats.referenceLength = orbit.getLength();
+        stats.referenceMs = orbit.getMilliseconds();
+        stats.seriesSkip = orbit.getSkip();
     }
 }
 
+const CalculatorStats &GridMandelbrotCalculator::getStats() const
+{
+    if (isPassThrough())
+        return tiles[0]->getStats();
+    return stats;
+}
+
 void GridMandelbrotCalculator::setEngineType(EngineType type)
 {
     if (engineType != type)
     {
         engineType = type;
         // Re-initialize calculators with new type
-        updateBounds(cre, cim, diam);
+        createTiles();
+        updateTileBounds();
     }
 }
 
+bool GridMandelbrotCalculator::parseEngineType(const std::string &name, EngineType &type)
+{
+    if (name == "border")
+        type = EngineType::BORDER;
+    else if (name == "bsimd")
+        type = EngineType::BORDER_SIMD;
+    else if (name == "standard")
+        type = EngineType::STANDARD;
+    else if (name == "simd")
+        type = EngineType::SIMD;
+    else if (name == "gpuf" || name == "gpu")
+        type = EngineType::GPUF;
+    else if (name == "gpud")
+        type = EngineType::GPUD;
+    else if (name == "gpuff")
+        type = EngineType::GPUFF;
+    else if (name == "gpuc")
+        type = EngineType::GPUC;
+    else if (name == "hybrid")
+        type = EngineType::HYBRID;
+    else if (name == "perturb")
+        type = EngineType::PERTURB;
+    else if (name == "psimd")
+        type = EngineType::PERTURB_SIMD;
+    else
+        return false;
+    return true;
+}
+
+const std::vector<IterationCount> &GridMandelbrotCalculator::getData() const
+{
+    return isPassThrough() ? tiles[0]->getData() : data;
+}
+
 bool GridMandelbrotCalculator::hasOwnOutput() const
 {
-    // No calculator has own output anymore
-    return false;
+    return isPassThrough();
+}
+
+void GridMandelbrotCalculator::setPalette(const std::vector<uint32_t> &palette)
+{
+    if (isPassThrough())
+        tiles[0]->setPalette(palette);
 }
 
-void GridMandelbrotCalculator::render()
+void GridMandelbrotCalculator::render(unsigned targetTexture)
 {
-    // Nothing to do here
+    if (isPassThrough())
+        tiles[0]->render(targetTexture);
 }
 
 std::string GridMandelbrotCalculator::getEngineName() const
@@ -329,6 +687,12 @@ std::string GridMandelbrotCalculator::getEngineName() const
         return "unknown";
     
     std::string baseName = tiles[0]->getEngineName();
+    if (engineType == EngineType::PERTURB)
+        baseName = "perturb";
+    else if (engineType == EngineType::PERTURB_SIMD)
+        baseName = "psimd";
+    else if (engineType == EngineType::HYBRID)
+        baseName = "hybrid";
     
     // Append grid info if grid is larger than 1x1
     if (gridRows > 1 || gridCols > 1)
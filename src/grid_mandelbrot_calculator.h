@@ -3,6 +3,8 @@
 #include "storage_mandelbrot_calculator.h"
 #include "border_mandelbrot_calculator.h"
 #include "standard_mandelbrot_calculator.h"
+#include "reference_orbit.h"
+#include "tile_cache.h"
 #include <vector>
 #include <memory>
 #include <functional>
@@ -14,29 +16,58 @@ public:
     enum class EngineType
     {
         BORDER,
+        BORDER_SIMD, // Boundary tracing with the queue evaluated by the SIMD kernel
         STANDARD,
         SIMD,
         GPUF, // GPU with float precision
-        GPUD  // GPU with double precision
+        GPUD, // GPU with double precision
+        GPUFF, // GPU with float-float (emulated double) precision
+        GPUC,  // GPU compute shader with double precision, in bounded passes
+        HYBRID, // Tiles of one grid on the GPU (double) and the SIMD engine at once
+        PERTURB,     // Boundary tracing of offsets from a high precision reference orbit
+        PERTURB_SIMD // The same with the SIMD engine traversal (every pixel, rows in chunks)
     };
 
     GridMandelbrotCalculator(int width, int height, int gridRows, int gridCols);
 
     void updateBounds(double cre, double cim, double diam) override;
     void updateBoundsExplicit(double minR, double minI, double maxR, double maxI) override;
+    void updateBoundsPrecise(const BigFloat &cre, const BigFloat &cim, double diam) override;
+    BigFloat getPreciseCre() const override { return preciseCre; }
+    BigFloat getPreciseCim() const override { return preciseCim; }
+    double getStepR() const override { return isPerturbationEngine(engineType) ? deltaStepR : stepr; }
+    double getStepI() const override { return isPerturbationEngine(engineType) ? deltaStepI : stepi; }
+    double getMinDiam() const override;
     void compute(std::function<void()> progressCallback) override;
     void reset() override;
+    bool setOutput(IterationCount *base, int pitch) override;
+    void seed(const FrameSnapshot &previous) override;
 
     void setSpeedMode(bool mode) override;
+    void setInteriorCheck(bool enabled) override;
+    void setMaxIterations(int maxIter) override;
+    void setCancelFlag(const std::atomic<bool> *flag) override;
 
     void setEngineType(EngineType type);
     EngineType getEngineType() const { return engineType; }
+
+    // Command line name (border, bsimd, standard, simd, gpuf, gpud, gpuff, gpuc, hybrid, perturb, psimd) to type
+    static bool parseEngineType(const std::string &name, EngineType &type);
+    static bool isGpuEngine(EngineType type) { return type == EngineType::GPUF || type == EngineType::GPUD || type == EngineType::GPUFF || type == EngineType::GPUC || type == EngineType::HYBRID; }
+    // Whether compute() draws with the GL context, so must run on the thread
+    // where it is current: the hybrid engine only does in speed mode
+    static bool usesGLContext(EngineType type, bool speedMode) { return isGpuEngine(type) && (type != EngineType::HYBRID || speedMode); }
+    static bool isPerturbationEngine(EngineType type) { return type == EngineType::PERTURB || type == EngineType::PERTURB_SIMD; }
     
     std::string getEngineName() const override;
+    const CalculatorStats &getStats() const override;
 
-    // Override to handle GPU pass-through
+    // Override to handle GPU pass-through: a single tile with its own output
+    // (GPU) keeps its frame, the grid neither copies nor reads it back
+    const std::vector<IterationCount> &getData() const override;
     bool hasOwnOutput() const override;
-    void render() override;
+    void setPalette(const std::vector<uint32_t> &palette) override;
+    void render(unsigned targetTexture) override;
 
 private:
     int gridRows;
@@ -45,6 +76,7 @@ private:
     EngineType engineType;
 
     std::vector<std::unique_ptr<MandelbrotCalculator>> tiles;
+    bool tilesShareOutput; // Tiles write straight into the grid output, nothing to composite
 
     // Helper structures to track tile geometry
     struct TileInfo
@@ -56,6 +88,45 @@ private:
     };
     std::vector<TileInfo> tileInfos;
 
+    // Parallel scheduling: last measured compute time of each tile (seconds)
+    // and the order in which tiles are handed to the thread pool
+    std::vector<double> tileCost;
+    std::vector<int> tileOrder;
+
+    // Hybrid: one GPU calculator as large as the largest tile, moved onto
+    // each tile it computes (created by the first hybrid frame, on the
+    // thread where the GL context is current), the stats of its tiles this
+    // frame, the side that computed each tile, and the throughput of both
+    // sides measured on the last frame (pixels per second, all pool workers
+    // for the CPU)
+    std::unique_ptr<MandelbrotCalculator> gpuTile;
+    CalculatorStats gpuStats;
+    std::vector<char> tileOnGpu;
+    double gpuRate, cpuRate;
+
+    // Tiles copied from the TileCache this frame, and whether the frame was
+    // seeded (its tiles then compute, to consume their seed)
+    std::vector<char> tileCached;
+    bool seededFrame;
+
+    // Perturbation: the exact center, and the view relative to it (the
+    // absolute bounds of a deep view all round to the same double). The
+    // tiles get offsets from the center and iterate them with the orbit.
+    BigFloat preciseCre, preciseCim;
+    double deltaMinR, deltaMinI;
+    double deltaStepR, deltaStepI;
+    ReferenceOrbit orbit;
+
     void calculateTileGeometry();
-    void compositeData();
+    void createTiles();
+    void updateDeltaBounds();
+    void updateTileBounds();
+    void attachTiles();
+    void compositeTile(int tileIdx);
+    void computeHybrid(const std::function<void()> &progressCallback);
+    TileCache::Key tileKey(int tileIdx) const;
+    void lookupCachedTiles();
+    void storeTile(int tileIdx);
+    void collectStats(double idleMs);
+    bool isPassThrough() const { return tiles.size() == 1 && tiles[0]->hasOwnOutput(); }
 };
@@ -0,0 +1,83 @@
+#include "headless_gl_context.h"
+#include <iostream>
+
+#ifdef HAVE_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <cstring>
+
+HeadlessGLContext::~HeadlessGLContext()
+{
+    if (context)
+    {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(display, context);
+    }
+    if (display)
+        eglTerminate(display);
+}
+
+bool HeadlessGLContext::create()
+{
+    // Prefer Mesa's surfaceless platform, which needs no X or Wayland
+    // server; otherwise take the default display
+    const char *extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+    if (extensions && std::strstr(extensions, "EGL_MESA_platform_surfaceless") && getPlatformDisplay)
+        eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    if (eglDisplay == EGL_NO_DISPLAY)
+        eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, nullptr, nullptr))
+    {
+        std::cerr << "EGL initialization failed" << std::endl;
+        return false;
+    }
+    display = eglDisplay;
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        std::cerr << "EGL has no desktop OpenGL" << std::endl;
+        return false;
+    }
+
+    // The shaders need GLSL 4.00
+    const EGLint attributes[] = {EGL_CONTEXT_MAJOR_VERSION, 4, EGL_CONTEXT_MINOR_VERSION, 0,
+                                 EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                                 EGL_NONE};
+    const EGLint configAttributes[] = {EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+    EGLConfig config = EGL_NO_CONFIG_KHR;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(eglDisplay, configAttributes, &config, 1, &configCount) || configCount == 0)
+        config = EGL_NO_CONFIG_KHR; // Needs EGL_KHR_no_config_context
+
+    EGLContext eglContext = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, attributes);
+    if (eglContext == EGL_NO_CONTEXT)
+    {
+        std::cerr << "EGL OpenGL 4.0 context creation failed (error 0x" << std::hex << eglGetError() << std::dec << ")" << std::endl;
+        return false;
+    }
+    context = eglContext;
+
+    if (!eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, eglContext))
+    {
+        std::cerr << "EGL context activation failed (error 0x" << std::hex << eglGetError() << std::dec << ")" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+#else
+
+HeadlessGLContext::~HeadlessGLContext()
+{
+}
+
+bool HeadlessGLContext::create()
+{
+    std::cerr << "GPU engines need EGL without a window (not available in this build)" << std::endl;
+    return false;
+}
+
+#endif
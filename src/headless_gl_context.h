@@ -0,0 +1,22 @@
+#pragma once
+
+// Offscreen OpenGL context for the GPU engines when there is no window
+// (headless render, benchmark). Uses surfaceless EGL: the GPU engine draws
+// into its own framebuffer object, so no EGL surface is needed.
+// Without EGL in the build, create() reports the problem and fails.
+class HeadlessGLContext
+{
+public:
+    HeadlessGLContext() = default;
+    ~HeadlessGLContext();
+
+    HeadlessGLContext(const HeadlessGLContext &) = delete;
+    HeadlessGLContext &operator=(const HeadlessGLContext &) = delete;
+
+    // Creates an OpenGL 4.0 core context and makes it current
+    bool create();
+
+private:
+    void *display = nullptr; // EGLDisplay
+    void *context = nullptr; // EGLContext
+};
@@ -0,0 +1,290 @@
+#include "headless_renderer.h"
+#include "grid_mandelbrot_calculator.h"
+#include "iteration_policy.h"
+#include "gradient.h"
+#include "thread_pool.h"
+#include "image_stream_writer.h"
+#include "headless_gl_context.h"
+#include "iteration_file.h"
+#include "stb_image_write.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <ctime>
+#include <format>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    // Images larger than this are streamed in bands even without --band
+    const long long STREAM_PIXELS = 64ll << 20;
+    const int DEFAULT_BAND_ROWS = 256;
+
+    // Palette entries (ARGB) to RGB bytes, bands of rows in parallel
+    void toRgb(const IterationCount *data, int width, int rows, const std::vector<uint32_t> &palette, int maxIter, unsigned char *rgb)
+    {
+        const int rowsPerBand = 32;
+        ThreadPool::instance().parallelFor((rows + rowsPerBand - 1) / rowsPerBand, [&](int band)
+                                           {
+            int yEnd = std::min(rows, (band + 1) * rowsPerBand);
+            for (int y = band * rowsPerBand; y < yEnd; ++y)
+            {
+                const IterationCount *src = data + static_cast<size_t>(y) * width;
+                unsigned char *dst = rgb + static_cast<size_t>(y) * width * 3;
+                for (int x = 0; x < width; ++x)
+                {
+                    uint32_t color = palette[std::min<int>(src[x], maxIter)];
+                    *dst++ = (color >> 16) & 0xFF;
+                    *dst++ = (color >> 8) & 0xFF;
+                    *dst++ = color & 0xFF;
+                }
+            } });
+    }
+
+    bool endsWith(const std::string &s, const char *suffix)
+    {
+        size_t n = std::strlen(suffix);
+        return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+    }
+
+    // Rows per band (the height when the image is written at once)
+    int chooseBandRows(int requested, const std::string &output, int width, int height)
+    {
+        int bandRows = requested;
+        if (bandRows <= 0 && (endsWith(output, ".ppm") || static_cast<long long>(width) * height > STREAM_PIXELS))
+            bandRows = DEFAULT_BAND_ROWS;
+        return bandRows > 0 ? std::min(bandRows, height) : height;
+    }
+
+    // Same colors as the interactive default (or a random palette)
+    void makePalette(bool randomPalette, int maxIter, std::vector<uint32_t> &palette)
+    {
+        std::unique_ptr<Gradient> gradient;
+        if (randomPalette)
+        {
+            srand(static_cast<unsigned>(time(nullptr)));
+            gradient = Gradient::createRandom();
+        }
+        else
+        {
+            gradient = std::make_unique<PolynomialGradient>(9.0, 15.0, 8.5);
+        }
+        gradient->bakePalette(maxIter, palette);
+    }
+}
+
+bool HeadlessRenderer::render(const Options &options)
+{
+    GridMandelbrotCalculator::EngineType engineType;
+    if (!GridMandelbrotCalculator::parseEngineType(options.engine, engineType))
+    {
+        std::cerr << "Unknown engine type: " << options.engine << std::endl;
+        return false;
+    }
+    if (options.width < 1 || options.height < 1)
+    {
+        std::cerr << "Invalid image size: " << options.width << "x" << options.height << std::endl;
+        return false;
+    }
+
+    bool gpuEngine = GridMandelbrotCalculator::isGpuEngine(engineType);
+    HeadlessGLContext glContext; // Must outlive the GPU calculator
+    if (gpuEngine && !glContext.create())
+        return false;
+
+    const int width = options.width;
+    const int height = options.height;
+
+    // Whole image in memory (compressed by stb), or a band of rows at a time
+    // through the streaming writer: then only one band of iteration counts,
+    // colors and engine work arrays exists, whatever the image size
+    int bandRows = chooseBandRows(options.bandRows, options.output, width, height);
+    bool streaming = bandRows < height || endsWith(options.output, ".ppm");
+
+    // Nothing is displayed, so always use every core: the border engines
+    // trace the whole band on the pool, the others compute a row of tiles.
+    // GPU bands are split in columns that fit in a texture; the hybrid
+    // engine shares the tiles of the CPU engines between GPU and CPU.
+    bool hybridEngine = engineType == GridMandelbrotCalculator::EngineType::HYBRID;
+    bool gpuTiles = gpuEngine && !hybridEngine;
+    bool borderEngine = engineType == GridMandelbrotCalculator::EngineType::BORDER ||
+                        engineType == GridMandelbrotCalculator::EngineType::BORDER_SIMD ||
+                        engineType == GridMandelbrotCalculator::EngineType::PERTURB;
+    int gridRows = 1;
+    int gridCols = gpuTiles ? (width + 8191) / 8192 : (borderEngine ? 1 : 8);
+    if (!streaming && !gpuTiles && !borderEngine)
+        gridRows = 8;
+
+    int maxIter = MandelbrotCalculator::MAX_ITER;
+    if (options.maxIter > 0)
+        maxIter = std::clamp(options.maxIter, 1, MandelbrotCalculator::MAX_ITER_LIMIT);
+    else if (options.adaptiveIter)
+        maxIter = IterationPolicy().estimateFromDepth(options.diam);
+
+    std::vector<uint32_t> palette;
+    makePalette(options.randomPalette, maxIter, palette);
+
+    // Each band is the view of its rows: centered on them, as high as they
+    // are, with the width of the whole image. Band centers are offsets from
+    // the image center, so bands work at any depth.
+    const double stepI = options.diam / height;
+    const int precision = BigFloat::limbsFor(stepI);
+
+    ImageStreamWriter writer;
+    if (streaming && !writer.open(options.output, width, height))
+        return false;
+    IterationFileWriter dump; // Opened with the first band, which knows the view
+
+    std::unique_ptr<GridMandelbrotCalculator> calculator;
+    std::vector<unsigned char> rgb(static_cast<size_t>(width) * bandRows * 3);
+    std::string engineName;
+    CalculatorStats stats; // Of all bands
+    double milliseconds = 0.0;
+    int bandCount = 0;
+
+    for (int y0 = 0; y0 < height; y0 += bandRows)
+    {
+        int rows = std::min(bandRows, height - y0);
+        if (!calculator || calculator->getHeight() != rows)
+        {
+            // Only the last band can be shorter
+            calculator = std::make_unique<GridMandelbrotCalculator>(width, rows, gridRows, gridCols);
+            calculator->setSpeedMode(true);
+            calculator->setInteriorCheck(options.interiorCheck);
+            calculator->setEngineType(engineType);
+            calculator->setMaxIterations(maxIter);
+            engineName = calculator->getEngineName();
+        }
+        if (streaming)
+        {
+            double offsetI = (y0 + rows * 0.5 - height * 0.5) * stepI;
+            calculator->updateBoundsPrecise(options.cre, options.cim + BigFloat(offsetI, precision), rows * stepI);
+        }
+        else
+        {
+            calculator->updateBoundsPrecise(options.cre, options.cim, options.diam);
+        }
+
+        auto startTime = std::chrono::high_resolution_clock::now();
+        calculator->compute(nullptr);
+        const auto &data = calculator->getData(); // GPU: reads the band back
+        auto endTime = std::chrono::high_resolution_clock::now();
+        milliseconds += std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count() / 1000.0;
+        stats.add(calculator->getStats());
+
+        if (!options.dump.empty())
+        {
+            if (y0 == 0)
+            {
+                // The first band starts at the top left of the image
+                IterationFileHeader header = IterationFileHeader::describe(*calculator, width, height);
+                header.cim = options.cim.toDouble();
+                header.diam = options.diam;
+                if (!dump.open(options.dump, header))
+                {
+                    std::cerr << "Failed to write " << options.dump << std::endl;
+                    return false;
+                }
+            }
+            if (!dump.writeRows(data.data(), rows))
+            {
+                std::cerr << "Failed to write " << options.dump << std::endl;
+                return false;
+            }
+        }
+
+        toRgb(data.data(), width, rows, palette, maxIter, rgb.data());
+        ++bandCount;
+
+        if (streaming && !writer.writeRows(rgb.data(), rows))
+        {
+            std::cerr << "Failed to write " << options.output << std::endl;
+            return false;
+        }
+    }
+
+    if (options.verbose)
+    {
+        std::cout << std::format("{} {:>4}x{:<4} {:>8.1f} ms  {:>20.16f} {:>20.16f} {:>12.2e} {:>6}\n",
+                                 engineName, width, height, milliseconds,
+                                 options.cre.toDouble(), options.cim.toDouble(), options.diam, maxIter);
+        std::cout << stats.describe() << std::endl;
+    }
+
+    bool saved = streaming ? writer.close() : stbi_write_png(options.output.c_str(), width, height, 3, rgb.data(), width * 3) != 0;
+    if (!saved)
+    {
+        std::cerr << "Failed to write " << options.output << std::endl;
+        return false;
+    }
+    if (!options.dump.empty() && !dump.close())
+    {
+        std::cerr << "Failed to write " << options.dump << std::endl;
+        return false;
+    }
+
+    if (options.verbose)
+    {
+        if (streaming)
+            std::cout << "Saved: " << options.output << " (" << bandCount << " bands of " << bandRows << " rows)" << std::endl;
+        else
+            std::cout << "Saved: " << options.output << std::endl;
+    }
+    return true;
+}
+
+bool HeadlessRenderer::recolor(const Options &options)
+{
+    MappedIterationFile file;
+    if (!file.open(options.input))
+        return false;
+
+    const IterationFileHeader &header = file.header();
+    const int width = header.width;
+    const int height = header.height;
+    const int maxIter = std::clamp<int>(header.maxIter, 1, MandelbrotCalculator::MAX_ITER_LIMIT);
+
+    std::vector<uint32_t> palette;
+    makePalette(options.randomPalette, maxIter, palette);
+
+    // Bands are colored straight from the mapping; only the pages of the
+    // band being colored need to be in memory
+    auto startTime = std::chrono::high_resolution_clock::now();
+    int bandRows = chooseBandRows(options.bandRows, options.output, width, height);
+    bool streaming = bandRows < height || endsWith(options.output, ".ppm");
+    std::vector<unsigned char> rgb(static_cast<size_t>(width) * bandRows * 3);
+
+    ImageStreamWriter writer;
+    if (streaming && !writer.open(options.output, width, height))
+        return false;
+
+    for (int y0 = 0; y0 < height; y0 += bandRows)
+    {
+        int rows = std::min(bandRows, height - y0);
+        toRgb(file.counts() + static_cast<size_t>(y0) * width, width, rows, palette, maxIter, rgb.data());
+        if (streaming && !writer.writeRows(rgb.data(), rows))
+        {
+            std::cerr << "Failed to write " << options.output << std::endl;
+            return false;
+        }
+    }
+
+    bool saved = streaming ? writer.close() : stbi_write_png(options.output.c_str(), width, height, 3, rgb.data(), width * 3) != 0;
+    if (!saved)
+    {
+        std::cerr << "Failed to write " << options.output << std::endl;
+        return false;
+    }
+
+    if (options.verbose)
+    {
+        auto endTime = std::chrono::high_resolution_clock::now();
+        double milliseconds = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count() / 1000.0;
+        std::cout << std::format("recolor {:>4}x{:<4} {:>8.1f} ms  {:>20.16f} {:>20.16f} {:>12.2e} {:>6}  (computed by {:.32s})\n",
+                                 width, height, milliseconds, header.cre, header.cim, header.diam, maxIter, header.engine);
+        std::cout << "Saved: " << options.output << std::endl;
+    }
+    return true;
+}
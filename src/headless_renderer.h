@@ -0,0 +1,38 @@
+#pragma once
+
+#include "big_float.h"
+#include <string>
+
+// Renders one view straight to a PNG file, for machines without a display:
+// no window and no SDL video. A GL context (EGL, surfaceless) is only
+// created when a GPU engine is selected.
+class HeadlessRenderer
+{
+public:
+    struct Options
+    {
+        BigFloat cre = BigFloat(-0.5); // Beyond a double for the perturbation engines
+        BigFloat cim = BigFloat(0.0);
+        double diam = 3.0;
+        int width = 800;
+        int height = 600;
+        std::string output;
+        std::string engine = "border";
+        int maxIter = 0;          // 0: default limit
+        bool adaptiveIter = false; // Limit from the zoom depth
+        bool interiorCheck = true;
+        bool randomPalette = false;
+        bool verbose = false;
+        int bandRows = 0; // Rows computed and written at a time, 0: whole image
+                          // (images over 64 Mpixels and PPM files are always streamed)
+        std::string dump;  // Also write the raw iteration counts there (IterationFile)
+        std::string input; // recolor(): the iteration file to color
+    };
+
+    // Returns false (after reporting on std::cerr) when no image was written
+    static bool render(const Options &options);
+
+    // Colors an iteration file (mapped, not loaded) into options.output with
+    // the palette options, without computing anything
+    static bool recolor(const Options &options);
+};
@@ -0,0 +1,246 @@
+#include "image_stream_writer.h"
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+    // Deflate length codes 257..285: base length and number of extra bits
+    const int lengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    const int lengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+
+    uint32_t crc32(const std::string &data, uint32_t crc = 0)
+    {
+        static uint32_t table[256];
+        static bool tableReady = false;
+        if (!tableReady)
+        {
+            for (uint32_t n = 0; n < 256; ++n)
+            {
+                uint32_t c = n;
+                for (int k = 0; k < 8; ++k)
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                table[n] = c;
+            }
+            tableReady = true;
+        }
+
+        crc = ~crc;
+        for (unsigned char byte : data)
+            crc = table[(crc ^ byte) & 0xFF] ^ (crc >> 8);
+        return ~crc;
+    }
+
+    void appendBigEndian(std::string &s, uint32_t value)
+    {
+        s.push_back(static_cast<char>(value >> 24));
+        s.push_back(static_cast<char>(value >> 16));
+        s.push_back(static_cast<char>(value >> 8));
+        s.push_back(static_cast<char>(value));
+    }
+
+    // Huffman codes are sent most significant bit first, the bit buffer
+    // is filled from the least significant end
+    uint32_t reverseBits(uint32_t code, int length)
+    {
+        uint32_t reversed = 0;
+        for (int i = 0; i < length; ++i)
+        {
+            reversed = (reversed << 1) | (code & 1);
+            code >>= 1;
+        }
+        return reversed;
+    }
+}
+
+ImageStreamWriter::~ImageStreamWriter()
+{
+    if (file)
+        fclose(file); // Incomplete image
+}
+
+bool ImageStreamWriter::open(const std::string &path, int w, int h)
+{
+    width = w;
+    height = h;
+    rowsWritten = 0;
+    png = !(path.size() >= 4 && path.compare(path.size() - 4, 4, ".ppm") == 0);
+
+    file = fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        std::cerr << "Cannot create " << path << std::endl;
+        return false;
+    }
+
+    if (!png)
+        return fprintf(file, "P6\n%d %d\n255\n", width, height) > 0;
+
+    static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    if (fwrite(signature, 1, sizeof(signature), file) != sizeof(signature))
+        return false;
+
+    std::string header;
+    appendBigEndian(header, width);
+    appendBigEndian(header, height);
+    header += std::string("\x08\x02\x00\x00\x00", 5); // 8 bits RGB, deflate, adaptive filters, no interlace
+    if (!writeChunk("IHDR", header))
+        return false;
+
+    // zlib header (32K window, fastest), then one fixed Huffman block that
+    // spans the whole image
+    bitBuffer = 0;
+    bitCount = 0;
+    adlerA = 1;
+    adlerB = 0;
+    lastByte = -1;
+    chunk.assign("\x78\x01", 2);
+    putBits(1, 1); // BFINAL
+    putBits(1, 2); // BTYPE = fixed Huffman
+    filtered.resize(1 + static_cast<size_t>(width) * 3);
+    return true;
+}
+
+void ImageStreamWriter::putBits(uint32_t bits, int count)
+{
+    bitBuffer |= bits << bitCount;
+    bitCount += count;
+    while (bitCount >= 8)
+    {
+        chunk.push_back(static_cast<char>(bitBuffer & 0xFF));
+        bitBuffer >>= 8;
+        bitCount -= 8;
+    }
+}
+
+void ImageStreamWriter::putLiteral(int value)
+{
+    // Fixed literal/length code (RFC 1951, 3.2.6)
+    if (value <= 143)
+        putBits(reverseBits(0x30 + value, 8), 8);
+    else if (value <= 255)
+        putBits(reverseBits(0x190 + value - 144, 9), 9);
+    else if (value <= 279)
+        putBits(reverseBits(value - 256, 7), 7);
+    else
+        putBits(reverseBits(0xC0 + value - 280, 8), 8);
+}
+
+void ImageStreamWriter::putRun(int length)
+{
+    // Repeat the previous byte: a match of this length at distance 1
+    int code = 28;
+    if (length < 258)
+    {
+        code = 27;
+        while (lengthBase[code] > length)
+            --code;
+    }
+    putLiteral(257 + code);
+    putBits(length - lengthBase[code], lengthExtra[code]);
+    putBits(0, 5); // Distance code 0: distance 1, no extra bits
+}
+
+void ImageStreamWriter::deflateBytes(const unsigned char *data, size_t size)
+{
+    // Adler-32, reduced every 5552 bytes (the most that cannot overflow)
+    for (size_t start = 0; start < size; start += 5552)
+    {
+        size_t end = std::min(size, start + 5552);
+        for (size_t i = start; i < end; ++i)
+        {
+            adlerA += data[i];
+            adlerB += adlerA;
+        }
+        adlerA %= 65521;
+        adlerB %= 65521;
+    }
+
+    size_t i = 0;
+    while (i < size)
+    {
+        size_t run = 0;
+        while (run < 258 && i + run < size && data[i + run] == lastByte)
+            ++run;
+
+        if (run >= 3)
+        {
+            putRun(static_cast<int>(run));
+            i += run;
+        }
+        else
+        {
+            putLiteral(data[i]);
+            lastByte = data[i];
+            ++i;
+        }
+    }
+}
+
+bool ImageStreamWriter::writeChunk(const char *type, const std::string &data)
+{
+    std::string typed(type, 4);
+    typed += data;
+
+    std::string lengthBytes, crcBytes;
+    appendBigEndian(lengthBytes, static_cast<uint32_t>(data.size()));
+    appendBigEndian(crcBytes, crc32(typed));
+
+    return fwrite(lengthBytes.data(), 1, 4, file) == 4 &&
+           fwrite(typed.data(), 1, typed.size(), file) == typed.size() &&
+           fwrite(crcBytes.data(), 1, 4, file) == 4;
+}
+
+bool ImageStreamWriter::writeRows(const unsigned char *rgb, int rows)
+{
+    if (!file || rowsWritten + rows > height)
+        return false;
+
+    size_t rowBytes = static_cast<size_t>(width) * 3;
+    if (!png)
+    {
+        if (fwrite(rgb, 1, rowBytes * rows, file) != rowBytes * rows)
+            return false;
+        rowsWritten += rows;
+        return true;
+    }
+
+    for (int y = 0; y < rows; ++y)
+    {
+        // Sub filter: each byte minus the same channel of the pixel to its
+        // left, so runs of one color become runs of zeros
+        const unsigned char *row = rgb + y * rowBytes;
+        filtered[0] = 1;
+        for (size_t x = 0; x < rowBytes; ++x)
+            filtered[1 + x] = static_cast<unsigned char>(row[x] - (x >= 3 ? row[x - 3] : 0));
+        deflateBytes(filtered.data(), filtered.size());
+    }
+    rowsWritten += rows;
+
+    // One IDAT chunk per band; the bits of an unfinished byte wait for the next one
+    bool ok = chunk.empty() || writeChunk("IDAT", chunk);
+    chunk.clear();
+    return ok;
+}
+
+bool ImageStreamWriter::close()
+{
+    if (!file)
+        return false;
+
+    bool ok = rowsWritten == height;
+    if (png)
+    {
+        putLiteral(256); // End of block
+        if (bitCount > 0)
+            putBits(0, 8 - bitCount);
+        appendBigEndian(chunk, (adlerB << 16) | adlerA);
+        ok = ok && writeChunk("IDAT", chunk) && writeChunk("IEND", "");
+        chunk.clear();
+    }
+
+    ok = fclose(file) == 0 && ok;
+    file = nullptr;
+    return ok;
+}
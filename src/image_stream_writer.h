@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Writes an RGB image a band of rows at a time, so images far larger than
+// memory can be saved: nothing but the current band has to be kept.
+// The format follows the file extension: ".ppm" gives a binary PPM (raw
+// bytes after a short header), anything else a PNG. PNG rows are Sub
+// filtered and deflated with run-length matches only (like zlib's Z_RLE
+// strategy), which is fast and catches the long runs of equal colors of
+// escape time images; each band becomes one IDAT chunk.
+class ImageStreamWriter
+{
+public:
+    ImageStreamWriter() = default;
+    ~ImageStreamWriter();
+
+    ImageStreamWriter(const ImageStreamWriter &) = delete;
+    ImageStreamWriter &operator=(const ImageStreamWriter &) = delete;
+
+    bool open(const std::string &path, int width, int height);
+
+    // rows * width * 3 bytes, top to bottom, continuing after the last call
+    bool writeRows(const unsigned char *rgb, int rows);
+
+    // Completes the file; fails if fewer rows than the height were written
+    bool close();
+
+private:
+    FILE *file = nullptr;
+    bool png = false;
+    int width = 0;
+    int height = 0;
+    int rowsWritten = 0;
+
+    // Deflate state, carried across bands (one single block for the image)
+    uint32_t bitBuffer = 0;
+    int bitCount = 0;
+    uint32_t adlerA = 1, adlerB = 0;
+    int lastByte = -1; // Previous uncompressed byte, the source of distance 1 matches
+
+    std::string chunk; // Compressed bytes of the IDAT chunk being built
+    std::vector<unsigned char> filtered; // One row with its filter type byte
+
+    void putBits(uint32_t bits, int count);
+    void putLiteral(int value);
+    void putRun(int length);
+    void deflateBytes(const unsigned char *data, size_t size);
+    bool writeChunk(const char *type, const std::string &data);
+};
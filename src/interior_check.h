@@ -0,0 +1,54 @@
+#pragma once
+
+// Shortcuts for points that never escape, shared by the CPU engines.
+// Both only answer "maxIter" for points whose double precision orbit stays
+// bounded forever, so images are identical with and without them.
+
+// Main cardioid and period-2 bulb, where most interior pixels of overview
+// frames lie
+inline bool inMainCardioidOrBulb(double x, double y)
+{
+    double y2 = y * y;
+    double xq = x - 0.25;
+    double q = xq * xq + y2;
+    if (q * (q + xq) <= 0.25 * y2)
+        return true;
+
+    double xb = x + 1.0;
+    return xb * xb + y2 <= 0.0625;
+}
+
+// Escape time with Brent periodicity detection: z is saved at iterations
+// 1, 2, 4, 8... and compared with every later z. An exact repeat means the
+// orbit is cycling (the map is deterministic), so it will never escape.
+inline int iterateWithPeriodicity(double x, double y, int maxIter)
+{
+    double r = x, i = y;
+    double savedR = r, savedI = i;
+    int saveAt = 1;
+
+    for (int iter = 0; iter < maxIter; ++iter)
+    {
+        double r2 = r * r;
+        double i2 = i * i;
+
+        if (r2 + i2 >= 4.0)
+            return iter;
+
+        double ri = r * i;
+        i = ri + ri + y; // z = z^2 + c
+        r = r2 - i2 + x;
+
+        if (r == savedR && i == savedI)
+            return maxIter;
+
+        if (iter + 1 == saveAt)
+        {
+            savedR = r;
+            savedI = i;
+            saveAt *= 2;
+        }
+    }
+
+    return maxIter;
+}
@@ -0,0 +1,146 @@
+#include "iteration_file.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    const char MAGIC[8] = {'M', 'B', 'I', 'T', 'E', 'R', '0', '1'};
+}
+
+IterationFileHeader IterationFileHeader::describe(const MandelbrotCalculator &calculator, int width, int height)
+{
+    IterationFileHeader header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.headerSize = sizeof(IterationFileHeader);
+    header.width = width;
+    header.height = height;
+    header.maxIter = calculator.getMaxIterations();
+    header.cre = calculator.getCre();
+    header.cim = calculator.getCim();
+    header.diam = calculator.getDiam();
+    header.minR = calculator.getMinR();
+    header.minI = calculator.getMinI();
+    header.stepR = calculator.getStepR();
+    header.stepI = calculator.getStepI();
+
+    // Engine names are padded for the verbose columns
+    std::string engine = calculator.getEngineName();
+    engine.erase(0, engine.find_first_not_of(' '));
+    std::strncpy(header.engine, engine.c_str(), sizeof(header.engine) - 1);
+    return header;
+}
+
+IterationFileWriter::~IterationFileWriter()
+{
+    if (file)
+        fclose(file); // Incomplete file
+}
+
+bool IterationFileWriter::open(const std::string &path, const IterationFileHeader &header)
+{
+    file = fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+
+    width = header.width;
+    height = header.height;
+    rowsWritten = 0;
+    return fwrite(&header, sizeof(header), 1, file) == 1;
+}
+
+bool IterationFileWriter::writeRows(const IterationCount *counts, int rows)
+{
+    if (!file || rowsWritten + rows > height)
+        return false;
+
+    size_t count = static_cast<size_t>(width) * rows;
+    if (fwrite(counts, sizeof(IterationCount), count, file) != count)
+        return false;
+    rowsWritten += rows;
+    return true;
+}
+
+bool IterationFileWriter::close()
+{
+    if (!file)
+        return false;
+
+    bool complete = rowsWritten == height;
+    bool closed = fclose(file) == 0;
+    file = nullptr;
+    return complete && closed;
+}
+
+MappedIterationFile::~MappedIterationFile()
+{
+    if (mapping)
+        munmap(mapping, size);
+}
+
+bool MappedIterationFile::open(const std::string &path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        std::cerr << "Cannot open " << path << std::endl;
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(IterationFileHeader)))
+    {
+        std::cerr << path << " is not an iteration file" << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    // The mapping keeps the file alive after the descriptor is closed
+    size = static_cast<size_t>(info.st_size);
+    void *address = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED)
+    {
+        std::cerr << "Cannot map " << path << std::endl;
+        return false;
+    }
+    mapping = address;
+
+    const IterationFileHeader &h = header();
+    if (std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0)
+    {
+        std::cerr << path << " is not an iteration file" << std::endl;
+        return false;
+    }
+    if (h.byteOrder != IterationFileHeader::BYTE_ORDER_MARK)
+    {
+        std::cerr << path << " was written with another byte order" << std::endl;
+        return false;
+    }
+    if (h.width < 1 || h.height < 1 || h.headerSize < sizeof(IterationFileHeader) ||
+        size < h.headerSize + static_cast<size_t>(h.width) * h.height * sizeof(IterationCount))
+    {
+        std::cerr << path << " is truncated" << std::endl;
+        return false;
+    }
+    // The counts are read in place (the mapping itself is page aligned)
+    if (h.headerSize % alignof(IterationCount) != 0)
+    {
+        std::cerr << path << " has misaligned counts" << std::endl;
+        return false;
+    }
+
+    // Colorized front to back: let the kernel read ahead
+    madvise(mapping, size, MADV_SEQUENTIAL);
+    return true;
+}
+
+const IterationCount *MappedIterationFile::counts() const
+{
+    return reinterpret_cast<const IterationCount *>(static_cast<const char *>(mapping) + header().headerSize);
+}
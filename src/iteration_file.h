@@ -0,0 +1,87 @@
+#pragma once
+
+#include "mandelbrot_calculator.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// Raw iteration counts of a frame, so a render can be recolored, searched
+// for zoom points or moved to another machine without computing it again.
+// A file is this header followed by width * height IterationCounts, rows
+// top to bottom, in the byte order of the machine that wrote it (checked
+// with the byte order mark). The view is informative: deep views are only
+// described to the precision of a double.
+struct IterationFileHeader
+{
+    char magic[8];            // "MBITER01"
+    uint32_t byteOrder;       // BYTE_ORDER_MARK as written
+    uint32_t headerSize;      // Offset of the counts
+    int32_t width;
+    int32_t height;
+    int32_t maxIter;
+    int32_t reserved0;
+    double cre, cim, diam;    // View center and diameter (the height)
+    double minR, minI;        // Sample of pixel (0, 0)
+    double stepR, stepI;      // Per pixel
+    char engine[32];          // Engine name, for the record
+    char reserved1[8];
+
+    static constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+    // A header for a width x height frame of the view described by the
+    // calculator (bounds, limit, engine)
+    static IterationFileHeader describe(const MandelbrotCalculator &calculator, int width, int height);
+};
+
+static_assert(sizeof(IterationFileHeader) == 128, "The header is part of the file format");
+
+// Writes a file a band of rows at a time, straight from the caller's
+// buffer (no conversion or copy), so huge renders can be dumped as they are
+// computed
+class IterationFileWriter
+{
+public:
+    IterationFileWriter() = default;
+    ~IterationFileWriter();
+
+    IterationFileWriter(const IterationFileWriter &) = delete;
+    IterationFileWriter &operator=(const IterationFileWriter &) = delete;
+
+    bool open(const std::string &path, const IterationFileHeader &header);
+
+    // rows * width counts, top to bottom, continuing after the last call
+    bool writeRows(const IterationCount *counts, int rows);
+
+    // Fails if fewer rows than the height were written
+    bool close();
+
+private:
+    FILE *file = nullptr;
+    int width = 0;
+    int height = 0;
+    int rowsWritten = 0;
+};
+
+// A file mapped read-only into memory: the counts are used in place, and
+// only the pages that are read are loaded
+class MappedIterationFile
+{
+public:
+    MappedIterationFile() = default;
+    ~MappedIterationFile();
+
+    MappedIterationFile(const MappedIterationFile &) = delete;
+    MappedIterationFile &operator=(const MappedIterationFile &) = delete;
+
+    // Returns false (after reporting on std::cerr) if the file cannot be
+    // mapped or is not a complete iteration file of this byte order
+    bool open(const std::string &path);
+
+    const IterationFileHeader &header() const { return *static_cast<const IterationFileHeader *>(mapping); }
+    const IterationCount *counts() const;
+
+private:
+    void *mapping = nullptr;
+    size_t size = 0;
+};
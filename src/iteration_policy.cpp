@@ -0,0 +1,72 @@
+#include "iteration_policy.h"
+#include <algorithm>
+#include <cmath>
+
+IterationPolicy::IterationPolicy(int minIter, int maxIter)
+    : minIter(minIter), maxIter(maxIter), lastChoice(0)
+{
+}
+
+int IterationPolicy::estimateFromDepth(double diam) const
+{
+    double octaves = std::max(0.0, std::log2(3.0 / diam));
+    double estimate = 256.0 + 64.0 * octaves;
+    return static_cast<int>(std::clamp(estimate, static_cast<double>(minIter), static_cast<double>(maxIter)));
+}
+
+int IterationPolicy::choose(double diam, const IterationCount *previous, size_t count, int previousMaxIter)
+{
+    int depthEstimate = estimateFromDepth(diam);
+    int target = depthEstimate;
+
+    // Escape time histogram of the previous frame (points that reached the
+    // limit are left out: they are either interior or cut off)
+    histogram.assign(previousMaxIter + 1, 0);
+    long long escaped = 0;
+    for (size_t p = 0; p < count; ++p)
+    {
+        int iter = previous[p];
+        if (iter < previousMaxIter)
+        {
+            ++histogram[iter];
+            ++escaped;
+        }
+    }
+
+    if (escaped > 0)
+    {
+        // Slowest escapes (99.9th percentile) and how many points escaped
+        // in the last quarter of the range, where the limit starts to cut
+        // off boundary detail
+        long long rank = escaped - escaped / 1000;
+        long long seen = 0;
+        int slowest = 0;
+        for (int iter = 0; iter < previousMaxIter; ++iter)
+        {
+            seen += histogram[iter];
+            if (seen >= rank)
+            {
+                slowest = iter;
+                break;
+            }
+        }
+
+        long long late = 0;
+        for (int iter = previousMaxIter * 3 / 4; iter < previousMaxIter; ++iter)
+            late += histogram[iter];
+
+        if (late * 200 > escaped)
+            target = std::max(target, previousMaxIter * 3 / 2); // More than 0.5% near the limit: raise it
+        else
+            target = std::min(target, std::max(2 * slowest, depthEstimate / 2));
+    }
+
+    target = std::clamp(target, minIter, maxIter);
+
+    // Avoid changing the palette scale for small variations
+    if (lastChoice > 0 && std::abs(target - lastChoice) * 5 < lastChoice)
+        target = lastChoice;
+
+    lastChoice = target;
+    return target;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "mandelbrot_calculator.h"
+#include <vector>
+
+// Chooses the iteration limit of the next frame from the zoom depth and
+// from the escape times of the previous frame, so shallow views do not pay
+// for iterations they never use and deep views keep their detail.
+class IterationPolicy
+{
+public:
+    IterationPolicy(int minIter = 128, int maxIter = 65535);
+
+    // diam: diameter of the next view
+    // previous / count / previousMaxIter: last computed frame, its number of
+    // pixels and the limit it used (pass a count of 0 when there is none)
+    int choose(double diam, const IterationCount *previous, size_t count, int previousMaxIter);
+
+    // Depth only estimate: 256 iterations for the full set, +64 per halving
+    // of the view
+    int estimateFromDepth(double diam) const;
+
+private:
+    int minIter;
+    int maxIter;
+    int lastChoice; // 0 until the first frame
+
+    std::vector<int> histogram;
+};
@@ -1,5 +1,11 @@
 #include "mandelbrot_app.h"
+#include "headless_renderer.h"
+#include "benchmark.h"
+#include "tile_cache.h"
+#include "iteration_file.h"
 #include <iostream>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 
 int main(int argc, char *argv[])
@@ -11,9 +17,25 @@ int main(int argc, char *argv[])
         bool exitAfterFirstDisplay = false;
         bool verboseMode = false;
         bool autoZoom = false;
+        bool smoothZoom = false;
         bool randomPalette = false;
+        bool interiorCheck = true;
+        bool adaptiveIter = false;
+        bool incrementalZoom = false;
+        bool progressive = false;
+        int maxIter = 0; // 0: default limit
         int pixelSize = 1;
         std::string engineType = "border"; // default to border tracing
+        bool engineGiven = false;
+        bool headless = false;
+        bool recolor = false;
+        HeadlessRenderer::Options render;
+        bool bench = false;
+        Benchmark::Options benchmark;
+        long tileCacheMb = TileCache::DEFAULT_BUDGET >> 20;
+        std::string tileCacheDir;
+        std::string recordPath;
+        std::string loadPath;
 
         for (int i = 1; i < argc; ++i)
         {
@@ -33,10 +55,167 @@ int main(int argc, char *argv[])
             {
                 autoZoom = true;
             }
+            else if (strcmp(argv[i], "--smooth-zoom") == 0)
+            {
+                smoothZoom = true;
+            }
             else if (strcmp(argv[i], "--random-palette") == 0 || strcmp(argv[i], "-p") == 0)
             {
                 randomPalette = true;
             }
+            else if (strcmp(argv[i], "--no-interior-check") == 0)
+            {
+                interiorCheck = false;
+            }
+            else if (strcmp(argv[i], "--max-iter") == 0)
+            {
+                if (i + 1 < argc)
+                {
+                    maxIter = std::atoi(argv[++i]);
+                    if (maxIter < 1) maxIter = 1;
+                }
+                else
+                {
+                    std::cerr << "Error: --max-iter requires an argument (1-65535)" << std::endl;
+                    return 1;
+                }
+            }
+            else if (strcmp(argv[i], "--adaptive-iter") == 0)
+            {
+                adaptiveIter = true;
+            }
+            else if (strcmp(argv[i], "--incremental") == 0)
+            {
+                incrementalZoom = true;
+            }
+            else if (strcmp(argv[i], "--progressive") == 0)
+            {
+                progressive = true;
+            }
+            else if (strcmp(argv[i], "--render") == 0)
+            {
+                // --render cre cim diam WxH out.png
+                // (the center keeps every digit given, for the perturbation engines)
+                if (i + 5 >= argc ||
+                    sscanf(argv[i + 4], "%dx%d", &render.width, &render.height) != 2 ||
+                    !BigFloat::parse(argv[i + 1], render.cre) || !BigFloat::parse(argv[i + 2], render.cim))
+                {
+                    std::cerr << "Error: --render requires: cre cim diam WxH out.png" << std::endl;
+                    return 1;
+                }
+                render.diam = std::atof(argv[i + 3]);
+                render.output = argv[i + 5];
+                i += 5;
+                headless = true;
+            }
+            else if (strcmp(argv[i], "--dump") == 0)
+            {
+                if (i + 1 < argc)
+                {
+                    render.dump = argv[++i];
+                }
+                else
+                {
+                    std::cerr << "Error: --dump requires a file name" << std::endl;
+                    return 1;
+                }
+            }
+            else if (strcmp(argv[i], "--recolor") == 0)
+            {
+                // --recolor in.mbi out.png
+                if (i + 2 >= argc)
+                {
+                    std::cerr << "Error: --recolor requires: in.mbi out.png" << std::endl;
+                    return 1;
+                }
+                render.input = argv[i + 1];
+                render.output = argv[i + 2];
+                i += 2;
+                recolor = true;
+            }
+            else if (strcmp(argv[i], "--band") == 0)
+            {
+                if (i + 1 < argc)
+                {
+                    render.bandRows = std::atoi(argv[++i]);
+                    if (render.bandRows < 1) render.bandRows = 1;
+                }
+                else
+                {
+                    std::cerr << "Error: --band requires an argument (rows)" << std::endl;
+                    return 1;
+                }
+            }
+            else if (strcmp(argv[i], "--bench") == 0)
+            {
+                bench = true;
+            }
+            else if (strcmp(argv[i], "--runs") == 0)
+            {
+                if (i + 1 < argc)
+                {
+                    benchmark.runs = std::atoi(argv[++i]);
+                    if (benchmark.runs < 1) benchmark.runs = 1;
+                }
+                else
+                {
+                    std::cerr << "Error: --runs requires an argument" << std::endl;
+                    return 1;
+                }
+            }
+            else if (strcmp(argv[i], "--json") == 0)
+            {
+                benchmark.json = true;
+            }
+            else if (strcmp(argv[i], "--tile-cache") == 0)
+            {
+                if (i + 1 < argc)
+                {
+                    tileCacheMb = std::atol(argv[++i]);
+                    if (tileCacheMb < 0) tileCacheMb = 0;
+                }
+                else
+                {
+                    std::cerr << "Error: --tile-cache requires an argument (MB, 0 to disable)" << std::endl;
+                    return 1;
+                }
+            }
+            else if (strcmp(argv[i], "--tile-cache-dir") == 0)
+            {
+                if (i + 1 < argc)
+                {
+                    tileCacheDir = argv[++i];
+                }
+                else
+                {
+                    std::cerr << "Error: --tile-cache-dir requires a directory" << std::endl;
+                    return 1;
+                }
+            }
+            else if (strcmp(argv[i], "--record") == 0)
+            {
+                if (i + 1 < argc)
+                {
+                    recordPath = argv[++i];
+                }
+                else
+                {
+                    std::cerr << "Error: --record requires a file name" << std::endl;
+                    return 1;
+                }
+            }
+            else if (strcmp(argv[i], "--load") == 0)
+            {
+                if (i + 1 < argc)
+                {
+                    loadPath = argv[++i];
+                }
+                else
+                {
+                    std::cerr << "Error: --load requires a file name" << std::endl;
+                    return 1;
+                }
+            }
             else if (strcmp(argv[i], "--pixel-size") == 0)
             {
                 if (i + 1 < argc)
@@ -56,10 +235,11 @@ int main(int argc, char *argv[])
                 if (i + 1 < argc)
                 {
                     engineType = argv[++i];
+                    engineGiven = true;
                 }
                 else
                 {
-                    std::cerr << "Error: --engine requires an argument (border|standard|simd|gpuf|gpud)" << std::endl;
+                    std::cerr << "Error: --engine requires an argument (border|bsimd|standard|simd|gpuf|gpud|gpuff|gpuc|hybrid|perturb|psimd)" << std::endl;
                     return 1;
                 }
             }
@@ -68,18 +248,52 @@ int main(int argc, char *argv[])
                 std::cout << "Mandelbrot Set Explorer with Boundary Tracing" << std::endl;
                 std::cout << "\nUsage: " << argv[0] << " [options]" << std::endl;
                 std::cout << "\nOptions:" << std::endl;
-                std::cout << "  --fast, -f, --speed, -s    Enable fast mode (parallel 4x4 grid)" << std::endl;
+                std::cout << "  --fast, -f, --speed, -s    Enable fast mode (parallel 8x8 grid)" << std::endl;
                 std::cout << "  --engine <type>            Set computation engine:" << std::endl;
                 std::cout << "                             border   = Boundary tracing (default, fastest)" << std::endl;
+                std::cout << "                             bsimd    = Boundary tracing, queue evaluated with SIMD" << std::endl;
                 std::cout << "                             standard = Standard pixel-by-pixel" << std::endl;
                 std::cout << "                             simd     = SIMD optimized" << std::endl;
                 std::cout << "                             gpuf     = GPU float precision (~50ms)" << std::endl;
                 std::cout << "                             gpud     = GPU double precision (~550ms)" << std::endl;
+                std::cout << "                             gpuff    = GPU float-float precision (deep as ~1e-11," << std::endl;
+                std::cout << "                                        without fp64)" << std::endl;
+                std::cout << "                             gpuc     = GPU compute shader, double precision, in short" << std::endl;
+                std::cout << "                                        passes (OpenGL 4.3)" << std::endl;
+                std::cout << "                             hybrid   = GPU and SIMD on the tiles of one frame" << std::endl;
+                std::cout << "                                        (double precision, speed mode)" << std::endl;
+                std::cout << "                             perturb  = Boundary tracing with perturbation (deep zoom," << std::endl;
+                std::cout << "                                        down to 1e-290)" << std::endl;
+                std::cout << "                             psimd    = SIMD traversal with perturbation" << std::endl;
                 std::cout << "  --pixel-size <1-20>        Set pixel size (1=normal, 10=blocky)" << std::endl;
                 std::cout << "  --random-palette, -p       Start with random color palette" << std::endl;
+                std::cout << "  --no-interior-check        Disable cardioid/bulb and periodicity checks" << std::endl;
+                std::cout << "  --max-iter <1-65535>       Set the iteration limit (default 768)" << std::endl;
+                std::cout << "  --adaptive-iter            Adapt the iteration limit to zoom depth and image" << std::endl;
+                std::cout << "  --incremental              Reuse the previous frame's pixels when zooming" << std::endl;
+                std::cout << "  --progressive              Coarse to fine rendering (CPU engines)" << std::endl;
                 std::cout << "  --auto-zoom, -a            Enable automatic zooming" << std::endl;
+                std::cout << "  --smooth-zoom              Auto-zoom with smooth transitions, the next frame" << std::endl;
+                std::cout << "                             computed while the current one is zoomed into" << std::endl;
                 std::cout << "  --verbose, -v              Enable verbose output (timing info)" << std::endl;
                 std::cout << "  --exit, -e                 Exit after first render (benchmarking)" << std::endl;
+                std::cout << "  --render cre cim diam WxH out.png" << std::endl;
+                std::cout << "                             Render one view to a PNG (or .ppm) without a window" << std::endl;
+                std::cout << "  --band <rows>              With --render: compute and write that many rows at" << std::endl;
+                std::cout << "                             a time, for images larger than memory" << std::endl;
+                std::cout << "  --dump <file.mbi>          With --render: also write the raw iteration counts" << std::endl;
+                std::cout << "  --recolor in.mbi out.png   Color an iteration dump (with --random-palette)" << std::endl;
+                std::cout << "  --bench                    Time every engine on fixed views, print CSV" << std::endl;
+                std::cout << "                             (only the --engine one if given, see --runs, --json)" << std::endl;
+                std::cout << "  --runs <n>                 With --bench: timed runs per engine and view (default 5)" << std::endl;
+                std::cout << "  --json                     With --bench: print JSON instead of CSV" << std::endl;
+                std::cout << "  --tile-cache <MB>          Memory for computed tiles kept for revisited views" << std::endl;
+                std::cout << "                             (default 256, 0 disables; not with --render, --bench)" << std::endl;
+                std::cout << "  --tile-cache-dir <dir>     Spill tiles evicted from the tile cache to files in dir" << std::endl;
+                std::cout << "                             (up to 4 times the memory budget, removed on exit)" << std::endl;
+                std::cout << "  --record <file>            Record the finished frames: .y4m video, .mp4/.mkv/" << std::endl;
+                std::cout << "                             .webm/.mov through ffmpeg, else a PNG sequence" << std::endl;
+                std::cout << "  --load <file.mbi>          Start from a dumped frame (the window takes its size)" << std::endl;
                 std::cout << "  --help, -h                 Show this help message" << std::endl;
                 std::cout << "\nKeyboard Controls:" << std::endl;
                 std::cout << "  ESC      - Quit (or cancel drag)" << std::endl;
@@ -87,12 +301,18 @@ int main(int argc, char *argv[])
                 std::cout << "  R        - Reset zoom to full set" << std::endl;
                 std::cout << "  F        - Toggle fast mode (parallel computation)" << std::endl;
                 std::cout << "  S        - Save screenshot" << std::endl;
+                std::cout << "  D        - Dump the raw iteration counts (.mbi)" << std::endl;
                 std::cout << "  Shift+S  - Toggle auto-screenshot mode" << std::endl;
-                std::cout << "  E        - Cycle engine (Border→Standard→SIMD→GPU-Float→GPU-Double)" << std::endl;
+                std::cout << "  Shift+R  - Toggle recording of the finished frames (.y4m)" << std::endl;
+                std::cout << "  E        - Cycle engine (Border→Border-SIMD→Standard→SIMD→GPU-Float→GPU-Double→GPU-Float-Float→GPU-Compute→Hybrid→Perturb→Perturb-SIMD)" << std::endl;
                 std::cout << "  P        - Random palette" << std::endl;
                 std::cout << "  V        - Toggle verbose mode" << std::endl;
                 std::cout << "  A        - Toggle auto-zoom" << std::endl;
+                std::cout << "  I        - Toggle interior checks (cardioid/bulb, periodicity)" << std::endl;
+                std::cout << "  G        - Toggle progressive rendering" << std::endl;
+                std::cout << "  Z        - Toggle incremental zoom (reuse the previous frame)" << std::endl;
                 std::cout << "  X        - Toggle pixel size (1x or 10x)" << std::endl;
+                std::cout << "  M        - Toggle smooth auto-zoom" << std::endl;
                 std::cout << "\nMouse Controls:" << std::endl;
                 std::cout << "  Drag       - Zoom into region" << std::endl;
                 std::cout << "  Shift+Drag - Zoom out from region" << std::endl;
@@ -101,10 +321,52 @@ int main(int argc, char *argv[])
             }
         }
 
-        // Default resolution 800x600
-        // Speed mode: 4x4 grid with parallel computation
+        if (bench)
+        {
+            if (engineGiven)
+                benchmark.engine = engineType;
+            benchmark.maxIter = maxIter;
+            benchmark.interiorCheck = interiorCheck;
+            benchmark.verbose = verboseMode;
+            return Benchmark::run(benchmark) ? 0 : 1;
+        }
+
+        if (recolor)
+        {
+            render.randomPalette = randomPalette;
+            render.verbose = verboseMode;
+            return HeadlessRenderer::recolor(render) ? 0 : 1;
+        }
+
+        if (headless)
+        {
+            render.engine = engineType;
+            render.maxIter = maxIter;
+            render.adaptiveIter = adaptiveIter;
+            render.interiorCheck = interiorCheck;
+            render.randomPalette = randomPalette;
+            render.verbose = verboseMode;
+            return HeadlessRenderer::render(render) ? 0 : 1;
+        }
+
+        // Revisited views (auto-zoom back home, zooming out) come from the
+        // tile cache. One-shot renders and benchmarks compute every frame.
+        TileCache::instance().configure(static_cast<size_t>(tileCacheMb) << 20, tileCacheDir);
+
+        // Default resolution 800x600, or that of the loaded frame
+        // Speed mode: 8x8 grid computed by the thread pool
         // Normal mode: 1x1 grid (single calculator) with progressive rendering
-        MandelbrotApp app(800, 600, speedMode, engineType);
+        int windowWidth = 800;
+        int windowHeight = 600;
+        if (!loadPath.empty())
+        {
+            MappedIterationFile file;
+            if (!file.open(loadPath))
+                return 1;
+            windowWidth = file.header().width * pixelSize;
+            windowHeight = file.header().height * pixelSize;
+        }
+        MandelbrotApp app(windowWidth, windowHeight, speedMode, engineType);
 
         if (exitAfterFirstDisplay)
         {
@@ -121,6 +383,16 @@ int main(int argc, char *argv[])
             app.setAutoZoom(true);
         }
 
+        if (smoothZoom)
+        {
+            app.setSmoothZoom(true);
+        }
+
+        if (!recordPath.empty() && !app.startRecording(recordPath))
+        {
+            return 1;
+        }
+
         if (randomPalette)
         {
             app.setRandomPalette();
@@ -131,6 +403,36 @@ int main(int argc, char *argv[])
             app.setPixelSize(pixelSize);
         }
 
+        if (!interiorCheck)
+        {
+            app.setInteriorCheck(false);
+        }
+
+        if (maxIter > 0)
+        {
+            app.setMaxIterations(maxIter);
+        }
+
+        if (adaptiveIter)
+        {
+            app.setAdaptiveIterations(true);
+        }
+
+        if (incrementalZoom)
+        {
+            app.setIncrementalZoom(true);
+        }
+
+        if (progressive)
+        {
+            app.setProgressive(true);
+        }
+
+        if (!loadPath.empty() && !app.loadIterations(loadPath))
+        {
+            return 1;
+        }
+
         app.run();
     }
     catch (const std::exception &e)
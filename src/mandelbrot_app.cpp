@@ -1,4 +1,8 @@
 #include "mandelbrot_app.h"
+#include "thread_pool.h"
+#include "iteration_file.h"
+#include "gpu_mandelbrot_calculator.h"
+#include "mapped_mandelbrot_calculator.h"
 #include <iostream>
 #include <iomanip>
 #include <stdexcept>
@@ -21,31 +25,15 @@
 
 MandelbrotApp::MandelbrotApp(int w, int h, bool speed, const std::string &engineType)
     : width(w), height(h), pixelSize(1), window(nullptr), renderer(nullptr), texture(nullptr), glContext(nullptr), ownsGLContext(false),
+      displayTextureId(0), gpuDisplayed(false), paletteGeneration(1), bakedGeneration(0), bakedOffset(0.0), bakedMix(0.0),
       autoZoomActive(false), speedMode(speed), verboseMode(false), exitAfterFirstDisplay(false),
-      autoScreenshotMode(false), cyclingActive(false), cyclingStep(0.003), mixAnimating(false), currentEngineType(GridMandelbrotCalculator::EngineType::BORDER)
+      autoScreenshotMode(false), cyclingActive(false), cyclingStep(0.003), mixAnimating(false), interiorCheck(true), maxIterations(MandelbrotCalculator::MAX_ITER), incrementalZoom(false), progressive(false),
+      smoothZoom(false), playbackActive(false), playbackTexture(nullptr), playbackRect{0, 0, 0, 0}, playbackMs(SMOOTH_ZOOM_MS),
+      imageSerial(0), recordedSerial(0),
+      cancelRequested(false), computeFinished(false), frameUpdated(false), frameComplete(false), fileLoaded(false), currentEngineType(GridMandelbrotCalculator::EngineType::BORDER)
 {
     // Parse engine type
-    if (engineType == "border")
-    {
-        currentEngineType = GridMandelbrotCalculator::EngineType::BORDER;
-    }
-    else if (engineType == "standard")
-    {
-        currentEngineType = GridMandelbrotCalculator::EngineType::STANDARD;
-    }
-    else if (engineType == "simd")
-    {
-        currentEngineType = GridMandelbrotCalculator::EngineType::SIMD;
-    }
-    else if (engineType == "gpuf" || engineType == "gpu")
-    {
-        currentEngineType = GridMandelbrotCalculator::EngineType::GPUF;
-    }
-    else if (engineType == "gpud")
-    {
-        currentEngineType = GridMandelbrotCalculator::EngineType::GPUD;
-    }
-    else
+    if (!GridMandelbrotCalculator::parseEngineType(engineType, currentEngineType))
     {
         std::cerr << "Unknown engine type: " << engineType << ", defaulting to BORDER" << std::endl;
         currentEngineType = GridMandelbrotCalculator::EngineType::BORDER;
@@ -103,32 +91,9 @@ MandelbrotApp::MandelbrotApp(int w, int h, bool speed, const std::string &engine
     {
         throw std::runtime_error(std::string("Texture creation failed: ") + SDL_GetError());
     }
+    updateDisplayTextureId();
 
-    // Speed mode: 4x4 grid with parallel computation
-    // Normal mode: 1x1 grid (effectively single calculator) with progressive rendering
-    if (currentEngineType == GridMandelbrotCalculator::EngineType::GPUF ||
-        currentEngineType == GridMandelbrotCalculator::EngineType::GPUD)
-    {
-        // GPU always uses 1x1 grid
-        auto gridCalc = std::make_unique<GridMandelbrotCalculator>(calcWidth, calcHeight, 1, 1);
-        gridCalc->setSpeedMode(speedMode);
-        gridCalc->setEngineType(currentEngineType);
-        calculator = std::move(gridCalc);
-    }
-    else if (speedMode)
-    {
-        auto gridCalc = std::make_unique<GridMandelbrotCalculator>(calcWidth, calcHeight, 4, 4);
-        gridCalc->setSpeedMode(true);
-        gridCalc->setEngineType(currentEngineType);
-        calculator = std::move(gridCalc);
-    }
-    else
-    {
-        auto gridCalc = std::make_unique<GridMandelbrotCalculator>(calcWidth, calcHeight, 1, 1);
-        gridCalc->setSpeedMode(false);
-        gridCalc->setEngineType(currentEngineType);
-        calculator = std::move(gridCalc);
-    }
+    createCalculator();
 
     zoomChooser = std::make_unique<ZoomPointChooser>(calcWidth, calcHeight);
 
@@ -151,8 +116,11 @@ MandelbrotApp::MandelbrotApp(int w, int h, bool speed, const std::string &engine
 
 MandelbrotApp::~MandelbrotApp()
 {
+    cancelCompute();
+    stopRecording();
     if (glContext && ownsGLContext)
         SDL_GL_DeleteContext(glContext);
+    releasePlaybackTexture();
     if (texture)
         SDL_DestroyTexture(texture);
     if (renderer)
@@ -191,92 +159,294 @@ void MandelbrotApp::initSDL()
 
 // Removed switchToOpenGL and switchToSDLRenderer as we now use a unified approach
 
+void MandelbrotApp::createCalculator()
+{
+    cancelCompute();
+
+    // GPU engines always use a 1x1 grid (the GL context is only current on this thread),
+    // except the hybrid one in speed mode: its grid is shared between the GPU
+    // (on this thread) and the thread pool
+    // Border engines trace the whole image on the thread pool themselves in
+    // speed mode, so they keep a 1x1 grid too (no re-traced tile seams)
+    // Speed mode: SPEED_GRID_SIZE x SPEED_GRID_SIZE tiles computed by the thread pool.
+    //             Many more tiles than cores, so the pool can balance the load.
+    // Normal mode: 1x1 grid (effectively single calculator) with progressive rendering
+    bool gpuEngine = GridMandelbrotCalculator::usesGLContext(currentEngineType, speedMode);
+    bool borderEngine = currentEngineType == GridMandelbrotCalculator::EngineType::BORDER ||
+                        currentEngineType == GridMandelbrotCalculator::EngineType::BORDER_SIMD ||
+                        currentEngineType == GridMandelbrotCalculator::EngineType::PERTURB;
+    bool hybridEngine = currentEngineType == GridMandelbrotCalculator::EngineType::HYBRID;
+    int gridSize = (speedMode && (hybridEngine || (!gpuEngine && !borderEngine))) ? SPEED_GRID_SIZE : 1;
+    auto engineType = currentEngineType;
+
+    auto makeGrid = [gridSize, engineType](int w, int h)
+    {
+        auto gridCalc = std::make_unique<GridMandelbrotCalculator>(w, h, gridSize, gridSize);
+        gridCalc->setEngineType(engineType);
+        return gridCalc;
+    };
+
+    // Progressive mode: each resolution level is a grid of the current engine
+    // (GPU engines are fast enough to draw full frames directly; the levels
+    // are placed in doubles, too coarse for the perturbation engines)
+    if (progressive && !gpuEngine && !GridMandelbrotCalculator::isPerturbationEngine(engineType))
+        calculator = std::make_unique<ProgressiveMandelbrotCalculator>(calcWidth, calcHeight, makeGrid);
+    else
+        calculator = makeGrid(calcWidth, calcHeight);
+
+    calculator->setSpeedMode(speedMode);
+    calculator->setInteriorCheck(interiorCheck);
+    calculator->setMaxIterations(maxIterations);
+    calculator->setCancelFlag(&cancelRequested);
+    fileLoaded = false;
+}
+
 void MandelbrotApp::compute()
 {
-    // For GPU mode, ensure OpenGL context is current
-    if ((currentEngineType == GridMandelbrotCalculator::EngineType::GPUF ||
-         currentEngineType == GridMandelbrotCalculator::EngineType::GPUD) &&
-        glContext)
+    // The view changed: whatever is still being computed is stale
+    cancelCompute();
+    frameComplete = false;
+
+    // For GPU mode, ensure OpenGL context is current (the hybrid engine
+    // without speed mode is the SIMD engine, computed in the background)
+    bool gpuEngine = GridMandelbrotCalculator::usesGLContext(currentEngineType, speedMode);
+    if (gpuEngine && glContext)
     {
         SDL_GL_MakeCurrent(window, glContext);
     }
 
-    auto startTime = std::chrono::high_resolution_clock::now();
+    // Adaptive limit: picked from the new depth and the previous frame
+    // (still in the calculator until it is recomputed)
+    if (iterationPolicy)
+    {
+        maxIterations = iterationPolicy->choose(calculator->getDiam(), calculator->getCounts(),
+                                                static_cast<size_t>(calcWidth) * calcHeight, calculator->getMaxIterations());
+        calculator->setMaxIterations(maxIterations);
+    }
 
-    calculator->compute([this]()
-                        {
-                            this->render();
-                        });
+    // A loaded frame cannot be computed: the engine takes over at the view
+    // it was moved to (with the limit chosen from the loaded frame)
+    if (fileLoaded)
+    {
+        BigFloat currentCre = calculator->getPreciseCre();
+        BigFloat currentCim = calculator->getPreciseCim();
+        double currentDiam = calculator->getDiam();
+        createCalculator();
+        calculator->updateBoundsPrecise(currentCre, currentCim, currentDiam);
+    }
+
+    // Incremental zoom: start from the previous frame (after the limit is
+    // known, as only counts computed with the same limit can be reused)
+    // and show it as a preview while computing
+    if (!previousFrame.empty())
+    {
+        calculator->seed(previousFrame);
+        previousFrame.data.clear();
+        render();
+    }
+
+    computeStart = std::chrono::high_resolution_clock::now();
+
+    if (gpuEngine)
+    {
+        // The GL context is only current on this thread
+        calculator->compute([this]()
+                            {
+                                this->render();
+                            });
+        computeEnd = std::chrono::high_resolution_clock::now();
+        finishCompute();
+        return;
+    }
+
+    // The progress callback only flags the frame: SDL belongs to the event
+    // loop, which renders the partial frame (each pixel read with loadCount
+    // shows its old or new count)
+    computeFinished.store(false);
+    frameUpdated.store(false);
+    computeThread = std::thread([this]()
+                                {
+        calculator->compute([this]()
+                            { frameUpdated.store(true, std::memory_order_release); });
+        computeEnd = std::chrono::high_resolution_clock::now();
+        computeFinished.store(true, std::memory_order_release); });
+}
+
+void MandelbrotApp::cancelCompute()
+{
+    if (!computeThread.joinable())
+        return;
+
+    cancelRequested.store(true);
+    computeThread.join();
+    cancelRequested.store(false);
+}
+
+void MandelbrotApp::waitForCompute()
+{
+    if (!computeThread.joinable())
+        return;
+
+    computeThread.join();
+    finishCompute();
+}
+
+void MandelbrotApp::pollCompute()
+{
+    // Called from the event loop
+    if (!computeThread.joinable())
+        return;
+
+    if (computeFinished.load(std::memory_order_acquire))
+    {
+        computeThread.join();
+        finishCompute();
+        render();
+    }
+    else if (frameUpdated.exchange(false, std::memory_order_acquire))
+    {
+        render();
+    }
+}
+
+void MandelbrotApp::finishCompute()
+{
+    frameComplete = true;
+    ++imageSerial;
 
     if (verboseMode)
     {
-        auto endTime = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(computeEnd - computeStart);
         double milliseconds = duration.count() / 1000.0;
 
         std::string engineName = calculator->getEngineName();
         
-        std::cout << std::format("{} {:>4}x{:<4} {:>8.1f} ms  {:>20.16f} {:>20.16f} {:>12.2e}\n",
+        std::cout << std::format("{} {:>4}x{:<4} {:>8.1f} ms  {:>20.16f} {:>20.16f} {:>12.2e} {:>6}\n",
                                  engineName,
                                  calculator->getWidth(), calculator->getHeight(),
                                  milliseconds,
-                                 calculator->getCre(), calculator->getCim(), calculator->getDiam());
+                                 calculator->getCre(), calculator->getCim(), calculator->getDiam(),
+                                 calculator->getMaxIterations());
+        std::cout << calculator->getStats().describe() << std::endl;
+
+        // Beyond what the doubles above show
+        if (calculator->getDiam() < 1e-13)
+        {
+            int digits = static_cast<int>(-std::log10(calculator->getDiam())) + 6;
+            std::cout << "  center " << calculator->getPreciseCre().toString(digits) << " "
+                      << calculator->getPreciseCim().toString(digits) << std::endl;
+        }
     }
 }
 
-void MandelbrotApp::render()
+void MandelbrotApp::updateDisplayTextureId()
 {
-    // Ensure GL context is active for GPU computation if needed
-    // But render() is for display. compute() is where the work happens.
-    // Since we read back data, we always use the CPU render path (SDL Renderer)
+    // The GPU display pass renders straight into the streaming texture,
+    // which needs its GL name (only available with the OpenGL renderer)
+    displayTextureId = 0;
+    float texW, texH;
+    if (SDL_GL_BindTexture(texture, &texW, &texH) == 0)
+    {
+        GLint id = 0;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &id);
+        displayTextureId = static_cast<unsigned>(id);
+        SDL_GL_UnbindTexture(texture);
+    }
+    gpuDisplayed = false;
+}
 
-    if (!renderer)
+void MandelbrotApp::bakePalette(int maxIter)
+{
+    // Only the cycling offset and the mix value are animated, anything else
+    // that changes the colors replaces the gradients and bumps the generation
+    double offset = cyclingGradient->getOffset();
+    double mix = mixGradient->getMixValue();
+    if (bakedGeneration == paletteGeneration && bakedOffset == offset && bakedMix == mix &&
+        palette.size() == static_cast<size_t>(maxIter) + 1)
         return;
 
+    bakedGeneration = paletteGeneration;
+    bakedOffset = offset;
+    bakedMix = mix;
+    ++imageSerial;
+
+    gradient->bakePalette(maxIter, palette);
+}
+
+void MandelbrotApp::colorizeToTexture()
+{
     Uint32 *pixels;
     int pitch;
 
     SDL_LockTexture(texture, nullptr, (void **)&pixels, &pitch);
+    colorizeInto(pixels, pitch);
+    SDL_UnlockTexture(texture);
+    gpuDisplayed = false;
+}
 
-    const auto &data = calculator->getData();
+void MandelbrotApp::colorizeInto(Uint32 *pixels, int pitch)
+{
+    // May read the frame back from the GPU; a loaded file is read in place
+    const IterationCount *data = calculator->getCounts();
+    const int maxIter = static_cast<int>(palette.size()) - 1;
 
-    for (int y = 0; y < calcHeight; ++y)
+    const int rowsPerBand = 32;
+    const int bands = (calcHeight + rowsPerBand - 1) / rowsPerBand;
+
+    // A gather per pixel, bands of rows in parallel. The counts may still be
+    // written by a compute in the background, so they are read as such.
+    auto colorizeBand = [&](int band)
     {
-        for (int x = 0; x < calcWidth; ++x)
+        int yEnd = std::min(calcHeight, (band + 1) * rowsPerBand);
+        for (int y = band * rowsPerBand; y < yEnd; ++y)
         {
-            int p = y * calcWidth + x;
-            int iter = data[p];
+            const IterationCount *src = &data[y * calcWidth];
+            Uint32 *dst = pixels + y * (pitch / 4);
+            for (int x = 0; x < calcWidth; ++x)
+                dst[x] = palette[std::min<int>(loadCount(src[x]), maxIter)];
+        }
+    };
 
-            if (iter == MandelbrotCalculator::MAX_ITER)
-            {
-                pixels[y * (pitch / 4) + x] = 0xFF000000; // Black (Alpha=255)
-            }
-            else
-            {
-                double t = static_cast<double>(iter) / MandelbrotCalculator::MAX_ITER;
-                SDL_Color color = gradient->getColor(t);
+    // While a frame computes in the background the pool is busy with it,
+    // and waiting for it would stall the event loop
+    if (isComputing())
+    {
+        for (int band = 0; band < bands; ++band)
+            colorizeBand(band);
+    }
+    else
+    {
+        ThreadPool::instance().parallelFor(bands, colorizeBand);
+    }
+}
 
-                if (iter % 2 != 0)
-                {
-                    // Shift value (brightness) for odd iterations
-                    const int shift = 34;
-                    color.r = std::min(255, color.r + shift);
-                    color.g = std::min(255, color.g + shift);
-                    color.b = std::min(255, color.b + shift);
-                }
-                // ARGB8888: A R G B
-                pixels[y * (pitch / 4) + x] = (0xFF << 24) | (color.r << 16) | (color.g << 8) | color.b;
-            }
-        }
+void MandelbrotApp::render()
+{
+    // GPU engines colorize their frame on the GPU, into the texture: the
+    // iterations are only read back when a CPU consumer asks for them.
+    // Otherwise the iterations are colorized here and uploaded.
+
+    if (!renderer)
+        return;
+
+    bakePalette(calculator->getMaxIterations());
+
+    if (calculator->hasOwnOutput() && displayTextureId)
+    {
+        SDL_RenderFlush(renderer); // The GPU pass must not reorder with queued SDL draws
+        calculator->setPalette(palette);
+        calculator->render(displayTextureId);
+        gpuDisplayed = true;
+    }
+    else
+    {
+        colorizeToTexture();
     }
 
-    SDL_UnlockTexture(texture);
+    present();
 
-    if (SDL_RenderClear(renderer) < 0)
-        std::cerr << "RenderClear failed: " << SDL_GetError() << std::endl;
-    if (SDL_RenderCopy(renderer, texture, nullptr, nullptr) < 0)
-        std::cerr << "RenderCopy failed: " << SDL_GetError() << std::endl;
-    SDL_RenderPresent(renderer);
+    if (recorder && frameComplete && imageSerial != recordedSerial)
+        recordFrame();
     
     // Auto-screenshot if mode is enabled
     if (autoScreenshotMode)
@@ -285,6 +455,35 @@ void MandelbrotApp::render()
     }
 }
 
+void MandelbrotApp::present()
+{
+    if (SDL_RenderClear(renderer) < 0)
+        std::cerr << "RenderClear failed: " << SDL_GetError() << std::endl;
+
+    if (playbackActive)
+    {
+        // Constant zoom rate towards the point the window and the region
+        // share, so that successive steps join up
+        auto now = std::chrono::high_resolution_clock::now();
+        double elapsed = std::chrono::duration<double, std::milli>(now - playbackStart).count();
+        double t = std::min(1.0, elapsed / playbackMs);
+        double r = static_cast<double>(playbackRect.w) / width;
+        double z = std::pow(1.0 / r, t);
+        double fixedX = playbackRect.x / (1.0 - r);
+        double fixedY = playbackRect.y / (1.0 - r);
+        SDL_FRect dst = {static_cast<float>(fixedX * (1.0 - z)), static_cast<float>(fixedY * (1.0 - z)),
+                         static_cast<float>(width * z), static_cast<float>(height * z)};
+        if (SDL_RenderCopyF(renderer, playbackTexture, nullptr, &dst) < 0)
+            std::cerr << "RenderCopy failed: " << SDL_GetError() << std::endl;
+    }
+    else if (SDL_RenderCopy(renderer, texture, nullptr, nullptr) < 0)
+    {
+        std::cerr << "RenderCopy failed: " << SDL_GetError() << std::endl;
+    }
+
+    SDL_RenderPresent(renderer);
+}
+
 SDL_Rect MandelbrotApp::calculateSelectionRect(int startX, int startY, int endX, int endY, bool centerBased)
 {
     int dx = endX - startX;
@@ -336,12 +535,13 @@ SDL_Rect MandelbrotApp::calculateSelectionRect(int startX, int startY, int endX,
 
 void MandelbrotApp::resetZoom()
 {
+    cancelCompute();
     calculator->updateBounds(-0.5, 0.0, 3.0);
 }
 
 bool MandelbrotApp::isZoomDisabled() const
 {
-    return calculator->getDiam() < 1e-15;
+    return calculator->getDiam() < calculator->getMinDiam();
 }
 
 void MandelbrotApp::setPixelSize(int newSize)
@@ -349,39 +549,21 @@ void MandelbrotApp::setPixelSize(int newSize)
     if (pixelSize == newSize)
         return;
 
+    endZoomPlayback();
+    releasePlaybackTexture();
+    stopRecording(); // The video has a fixed size
+
     // Save current view parameters
-    double currentCre = calculator->getCre();
-    double currentCim = calculator->getCim();
+    BigFloat currentCre = calculator->getPreciseCre();
+    BigFloat currentCim = calculator->getPreciseCim();
     double currentDiam = calculator->getDiam();
 
     pixelSize = newSize;
     calcWidth = width / pixelSize;
     calcHeight = height / pixelSize;
 
-    // Recreate calculator with appropriate grid size based on speed mode
-    if (currentEngineType == GridMandelbrotCalculator::EngineType::GPUF ||
-        currentEngineType == GridMandelbrotCalculator::EngineType::GPUD)
-    {
-        auto gridCalc = std::make_unique<GridMandelbrotCalculator>(calcWidth, calcHeight, 1, 1);
-        gridCalc->setSpeedMode(speedMode);
-        gridCalc->setEngineType(currentEngineType);
-        calculator = std::move(gridCalc);
-    }
-    else if (speedMode)
-    {
-        auto gridCalc = std::make_unique<GridMandelbrotCalculator>(calcWidth, calcHeight, 4, 4);
-        gridCalc->setSpeedMode(true);
-        gridCalc->setEngineType(currentEngineType);
-        calculator = std::move(gridCalc);
-    }
-    else
-    {
-        auto gridCalc = std::make_unique<GridMandelbrotCalculator>(calcWidth, calcHeight, 1, 1);
-        gridCalc->setSpeedMode(false);
-        gridCalc->setEngineType(currentEngineType);
-        calculator = std::move(gridCalc);
-    }
-    calculator->updateBounds(currentCre, currentCim, currentDiam);
+    createCalculator();
+    calculator->updateBoundsPrecise(currentCre, currentCim, currentDiam);
 
     zoomChooser = std::make_unique<ZoomPointChooser>(calcWidth, calcHeight);
 
@@ -396,6 +578,7 @@ void MandelbrotApp::setPixelSize(int newSize)
     {
         throw std::runtime_error(std::string("Texture creation failed: ") + SDL_GetError());
     }
+    updateDisplayTextureId();
 
     // Recompute
     compute();
@@ -409,9 +592,13 @@ void MandelbrotApp::handleResize(int newWidth, int newHeight)
     if (newWidth == width && newHeight == height)
         return;
 
+    endZoomPlayback();
+    releasePlaybackTexture();
+    stopRecording(); // The video has a fixed size
+
     // Save current view parameters
-    double currentCre = calculator->getCre();
-    double currentCim = calculator->getCim();
+    BigFloat currentCre = calculator->getPreciseCre();
+    BigFloat currentCim = calculator->getPreciseCim();
     double currentDiam = calculator->getDiam();
 
     // Update dimensions
@@ -420,30 +607,8 @@ void MandelbrotApp::handleResize(int newWidth, int newHeight)
     calcWidth = width / pixelSize;
     calcHeight = height / pixelSize;
 
-    // Recreate calculator with appropriate grid size based on speed mode
-    if (currentEngineType == GridMandelbrotCalculator::EngineType::GPUF ||
-        currentEngineType == GridMandelbrotCalculator::EngineType::GPUD)
-    {
-        auto gridCalc = std::make_unique<GridMandelbrotCalculator>(calcWidth, calcHeight, 1, 1);
-        gridCalc->setSpeedMode(speedMode);
-        gridCalc->setEngineType(currentEngineType);
-        calculator = std::move(gridCalc);
-    }
-    else if (speedMode)
-    {
-        auto gridCalc = std::make_unique<GridMandelbrotCalculator>(calcWidth, calcHeight, 4, 4);
-        gridCalc->setSpeedMode(true);
-        gridCalc->setEngineType(currentEngineType);
-        calculator = std::move(gridCalc);
-    }
-    else
-    {
-        auto gridCalc = std::make_unique<GridMandelbrotCalculator>(calcWidth, calcHeight, 1, 1);
-        gridCalc->setSpeedMode(false);
-        gridCalc->setEngineType(currentEngineType);
-        calculator = std::move(gridCalc);
-    }
-    calculator->updateBounds(currentCre, currentCim, currentDiam);
+    createCalculator();
+    calculator->updateBoundsPrecise(currentCre, currentCim, currentDiam);
 
     // Recreate zoom chooser
     zoomChooser = std::make_unique<ZoomPointChooser>(calcWidth, calcHeight);
@@ -459,6 +624,7 @@ void MandelbrotApp::handleResize(int newWidth, int newHeight)
     {
         throw std::runtime_error(std::string("Texture creation failed: ") + SDL_GetError());
     }
+    updateDisplayTextureId();
 
     // Recompute with new dimensions
     compute();
@@ -478,29 +644,35 @@ void MandelbrotApp::zoomToRegion(int x1, int y1, int x2, int y2)
     if (y1 > y2)
         std::swap(y1, y2);
 
-    // Convert pixel coordinates to complex plane
-    double minr = calculator->getMinR();
-    double mini = calculator->getMinI();
-    double stepr = calculator->getStepR();
-    double stepi = calculator->getStepI();
+    // Convert pixel coordinates to offsets from the view center, which a
+    // double holds at any depth (the center itself may need more bits)
+    double spanR = calculator->getStepR() * calcWidth;
+    double spanI = calculator->getStepI() * calcHeight;
 
     // Adjust for resolution difference between window and calculation
-    double re1 = minr + (x1 / (double)width) * (stepr * calcWidth);
-    double im1 = mini + (y1 / (double)height) * (stepi * calcHeight);
-    double re2 = minr + (x2 / (double)width) * (stepr * calcWidth);
-    double im2 = mini + (y2 / (double)height) * (stepi * calcHeight);
+    double re1 = (x1 / (double)width - 0.5) * spanR;
+    double im1 = (y1 / (double)height - 0.5) * spanI;
+    double re2 = (x2 / (double)width - 0.5) * spanR;
+    double im2 = (y2 / (double)height - 0.5) * spanI;
 
-    double new_cre = (re1 + re2) / 2.0;
-    double new_cim = (im1 + im2) / 2.0;
     double new_diam = std::max(re2 - re1, im2 - im1);
+    moveView((re1 + re2) / 2.0, (im1 + im2) / 2.0, new_diam);
+}
 
-    calculator->updateBounds(new_cre, new_cim, new_diam);
-}void MandelbrotApp::animateRectToRect(int startX, int startY, int startWidth, int startHeight,
+void MandelbrotApp::moveView(double offsetR, double offsetI, double newDiam)
+{
+    int precision = BigFloat::limbsFor(newDiam);
+    calculator->updateBoundsPrecise(calculator->getPreciseCre() + BigFloat(offsetR, precision),
+                                    calculator->getPreciseCim() + BigFloat(offsetI, precision),
+                                    newDiam);
+}
+
+void MandelbrotApp::animateRectToRect(int startX, int startY, int startWidth, int startHeight,
                                       int endX, int endY, int endWidth, int endHeight,
                                       int steps, int frameDelay)
 {
-    // Skip animation in speed mode
-    if (calculator->getSpeedMode())
+    // Skip animation in speed mode (and when the zoom is played smoothly)
+    if (calculator->getSpeedMode() || playbackActive)
         return;
 
     // Animate rectangle transformation over specified number of steps
@@ -551,6 +723,78 @@ void MandelbrotApp::blinkRect(int x, int y, int w, int h, int times, int blinkDe
     }
 }
 
+void MandelbrotApp::startZoomPlayback(int x1, int y1, int x2, int y2)
+{
+    if (x2 - x1 <= 0 || x2 - x1 >= width)
+    {
+        zoomToRect(x1, y1, x2, y2, false);
+        return;
+    }
+
+    if (!playbackTexture)
+    {
+        playbackTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+                                            SDL_TEXTUREACCESS_STREAMING, calcWidth, calcHeight);
+        if (!playbackTexture)
+        {
+            std::cerr << "Texture creation failed: " << SDL_GetError() << std::endl;
+            zoomToRect(x1, y1, x2, y2, false);
+            return;
+        }
+        SDL_SetTextureBlendMode(playbackTexture, SDL_BLENDMODE_NONE);
+    }
+
+    // The finished frame moves to the playback texture as it is (GPU engines
+    // drew it there, nothing is read back or copied) and the next frame is
+    // computed into the other one. The transition is filtered, the frames
+    // keep their square pixels.
+    std::swap(texture, playbackTexture);
+    updateDisplayTextureId();
+    SDL_SetTextureScaleMode(playbackTexture, SDL_ScaleModeLinear);
+    SDL_SetTextureScaleMode(texture, SDL_ScaleModeNearest);
+
+    // Frames slower than the transition stretch it instead of leaving it
+    // stopped at the end
+    double lastMs = std::chrono::duration<double, std::milli>(computeEnd - computeStart).count();
+    playbackMs = std::max(SMOOTH_ZOOM_MS, lastMs);
+    playbackRect = {x1, y1, x2 - x1, y2 - y1};
+    playbackStart = std::chrono::high_resolution_clock::now();
+    playbackActive = true;
+
+    zoomToRect(x1, y1, x2, y2, false);
+}
+
+void MandelbrotApp::updateZoomPlayback()
+{
+    // Called from the event loop
+    if (!playbackActive)
+        return;
+
+    auto now = std::chrono::high_resolution_clock::now();
+    if (std::chrono::duration<double, std::milli>(now - playbackStart).count() >= playbackMs && !isComputing())
+        endZoomPlayback();
+    else
+        present();
+}
+
+void MandelbrotApp::endZoomPlayback()
+{
+    if (!playbackActive)
+        return;
+
+    // The texture holds the next frame (or its progress so far)
+    playbackActive = false;
+    present();
+}
+
+void MandelbrotApp::releasePlaybackTexture()
+{
+    // Recreated at the next transition, at the current size
+    if (playbackTexture)
+        SDL_DestroyTexture(playbackTexture);
+    playbackTexture = nullptr;
+}
+
 void MandelbrotApp::zoomToRect(int x1, int y1, int x2, int y2, bool inverse)
 {
     // Disable zoom-in when diameter is too small
@@ -559,6 +803,14 @@ void MandelbrotApp::zoomToRect(int x1, int y1, int x2, int y2, bool inverse)
         return;
     }
 
+    cancelCompute();
+
+    // GPU frames are cheap to redraw and would have to be read back; an
+    // interrupted frame has unfinished pixels
+    bool reuse = incrementalZoom && frameComplete && !calculator->hasOwnOutput();
+    if (reuse)
+        previousFrame.capture(*calculator);
+
     if (inverse)
     {
         // Zoom OUT: animate full screen shrinking to rectangle
@@ -573,10 +825,30 @@ void MandelbrotApp::zoomToRect(int x1, int y1, int x2, int y2, bool inverse)
         double effectiveStepR = calculator->getStepR() * ((double)calcWidth / width);
         double effectiveStepI = calculator->getStepI() * ((double)calcHeight / height);
 
-        double new_cre = calculator->getCre() + offsetX * effectiveStepR * scale;
-        double new_cim = calculator->getCim() + offsetY * effectiveStepI * scale;
-        double new_diam = calculator->getDiam() * scale;
-        calculator->updateBounds(new_cre, new_cim, new_diam);
+        double offsetR, offsetI;
+        if (reuse)
+        {
+            // Integer scale and a shift by whole pixels: every old sample lands
+            // on a new one, and 1/scale^2 of the new frame is already computed
+            scale = std::max(2.0, std::round(scale));
+            int k = static_cast<int>(scale);
+            int calcOffsetX = (int)std::lround(offsetX * (double)calcWidth / width);
+            int calcOffsetY = (int)std::lround(offsetY * (double)calcHeight / height);
+            offsetR = calcOffsetX * calculator->getStepR() * scale;
+            offsetI = calcOffsetY * calculator->getStepI() * scale;
+
+            // With an odd (k - 1) * size, the new grid is half a pixel off
+            if ((k - 1) * calcWidth % 2)
+                offsetR += 0.5 * calculator->getStepR();
+            if ((k - 1) * calcHeight % 2)
+                offsetI += 0.5 * calculator->getStepI();
+        }
+        else
+        {
+            offsetR = offsetX * effectiveStepR * scale;
+            offsetI = offsetY * effectiveStepI * scale;
+        }
+        moveView(offsetR, offsetI, calculator->getDiam() * scale);
     }
     else
     {
@@ -600,26 +872,35 @@ void MandelbrotApp::run()
     std::cout << "  R        - Reset zoom to full set" << std::endl;
     std::cout << "  F        - Toggle fast mode (parallel computation)" << std::endl;
     std::cout << "  S        - Save screenshot" << std::endl;
+    std::cout << "  D        - Dump the raw iteration counts (.mbi)" << std::endl;
     std::cout << "  Shift+S  - Toggle auto-screenshot mode" << std::endl;
-    std::cout << "  E        - Cycle engine (Border→Standard→SIMD→GPU-Float→GPU-Double)" << std::endl;
+    std::cout << "  Shift+R  - Toggle recording of the finished frames (.y4m video)" << std::endl;
+    std::cout << "  E        - Cycle engine (Border→Border-SIMD→Standard→SIMD→GPU-Float→GPU-Double→GPU-Float-Float→GPU-Compute→Hybrid→Perturb→Perturb-SIMD)" << std::endl;
     std::cout << "  P        - Random palette" << std::endl;
     std::cout << "  Shift+P  - Smooth palette shift to new random palette" << std::endl;
     std::cout << "  C        - Toggle palette cycling animation (forward)" << std::endl;
     std::cout << "  Shift+C  - Toggle palette cycling animation (reverse)" << std::endl;
     std::cout << "  V        - Toggle verbose mode" << std::endl;
     std::cout << "  A        - Toggle auto-zoom" << std::endl;
+    std::cout << "  G        - Toggle progressive rendering (1/8, 1/4, 1/2 then full resolution)" << std::endl;
+    std::cout << "  Z        - Toggle incremental zoom (reuse the previous frame)" << std::endl;
     std::cout << "  X        - Toggle pixel size (1x or 10x)" << std::endl;
+    std::cout << "  M        - Toggle smooth auto-zoom (next frame computed during the transition)" << std::endl;
     std::cout << "\nMouse controls:" << std::endl;
     std::cout << "  Drag     - Zoom into region" << std::endl;
     std::cout << "  Shift+Drag - Zoom out from region" << std::endl;
     std::cout << "  Ctrl+Drag  - Center-based zoom" << std::endl;
     }
 
-    compute();
+    // A loaded frame is shown as it is
+    if (!fileLoaded)
+        compute();
     render();
 
     if (exitAfterFirstDisplay)
     {
+        waitForCompute();
+        render();
         std::cout << "Exiting after first display as requested" << std::endl;
         return;
     }
@@ -636,6 +917,10 @@ void MandelbrotApp::run()
     {
         while (SDL_PollEvent(&event))
         {
+            // Any interaction takes the screen back from a zoom transition
+            if (event.type == SDL_KEYDOWN || event.type == SDL_MOUSEBUTTONDOWN)
+                endZoomPlayback();
+
             switch (event.type)
             {
             case SDL_QUIT:
@@ -666,16 +951,40 @@ void MandelbrotApp::run()
                 }
                 else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_SPACE)
                 {
+                    cancelCompute();
                     calculator->reset();
                     compute();
                     render();
                 }
                 else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_r)
                 {
-                    resetZoom();
-                    calculator->reset();
-                    compute();
-                    render();
+                    if (SDL_GetModState() & KMOD_SHIFT)
+                    {
+                        // Toggle recording (Shift+R)
+                        if (recorder)
+                        {
+                            stopRecording();
+                        }
+                        else
+                        {
+                            try
+                            {
+                                if (startRecording(generateUniqueFilename("mandelbrot", ".y4m")))
+                                    render(); // Records the current frame
+                            }
+                            catch (const std::runtime_error& e)
+                            {
+                                std::cerr << "Failed to generate unique filename: " << e.what() << std::endl;
+                            }
+                        }
+                    }
+                    else
+                    {
+                        resetZoom();
+                        calculator->reset();
+                        compute();
+                        render();
+                    }
                 }
                 else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_s)
                 {
@@ -698,41 +1007,28 @@ void MandelbrotApp::run()
                         saveScreenshot("mandelbrot");
                     }
                 }
+                else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_d)
+                {
+                    dumpIterations("mandelbrot");
+                }
                 else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_f)
                 {
                     // Toggle fast/speed mode
                     speedMode = !speedMode;
 
                     // Save current view parameters
-                    double currentCre = calculator->getCre();
-                    double currentCim = calculator->getCim();
+                    BigFloat currentCre = calculator->getPreciseCre();
+                    BigFloat currentCim = calculator->getPreciseCim();
                     double currentDiam = calculator->getDiam();
 
                     // Recreate calculator with appropriate grid size
-                    if (currentEngineType == GridMandelbrotCalculator::EngineType::GPUF ||
-                        currentEngineType == GridMandelbrotCalculator::EngineType::GPUD)
+                    createCalculator();
+                    if (GridMandelbrotCalculator::isGpuEngine(currentEngineType) &&
+                        currentEngineType != GridMandelbrotCalculator::EngineType::HYBRID)
                     {
-                        auto gridCalc = std::make_unique<GridMandelbrotCalculator>(calcWidth, calcHeight, 1, 1);
-                        gridCalc->setSpeedMode(speedMode);
-                        gridCalc->setEngineType(currentEngineType);
-                        calculator = std::move(gridCalc);
                         std::cout << "Speed mode: " << (speedMode ? "ON" : "OFF") << " (GPU 1x1)" << std::endl;
                     }
-                    else if (speedMode)
-                    {
-                        auto gridCalc = std::make_unique<GridMandelbrotCalculator>(calcWidth, calcHeight, 4, 4);
-                        gridCalc->setSpeedMode(true);
-                        gridCalc->setEngineType(currentEngineType);
-                        calculator = std::move(gridCalc);
-                    }
-                    else
-                    {
-                        auto gridCalc = std::make_unique<GridMandelbrotCalculator>(calcWidth, calcHeight, 1, 1);
-                        gridCalc->setSpeedMode(false);
-                        gridCalc->setEngineType(currentEngineType);
-                        calculator = std::move(gridCalc);
-                    }
-                    calculator->updateBounds(currentCre, currentCim, currentDiam);
+                    calculator->updateBoundsPrecise(currentCre, currentCim, currentDiam);
 
                     // Recompute with new calculator
                     compute();
@@ -742,6 +1038,10 @@ void MandelbrotApp::run()
                 {
                     // Toggle engine type
                     if (currentEngineType == GridMandelbrotCalculator::EngineType::BORDER)
+                    {
+                        currentEngineType = GridMandelbrotCalculator::EngineType::BORDER_SIMD;
+                    }
+                    else if (currentEngineType == GridMandelbrotCalculator::EngineType::BORDER_SIMD)
                     {
                         currentEngineType = GridMandelbrotCalculator::EngineType::STANDARD;
                     }
@@ -757,38 +1057,45 @@ void MandelbrotApp::run()
                     {
                         currentEngineType = GridMandelbrotCalculator::EngineType::GPUD;
                     }
+                    else if (currentEngineType == GridMandelbrotCalculator::EngineType::GPUD)
+                    {
+                        currentEngineType = GridMandelbrotCalculator::EngineType::GPUFF;
+                    }
+                    else if (currentEngineType == GridMandelbrotCalculator::EngineType::GPUFF)
+                    {
+                        // The compute engine is skipped below OpenGL 4.3
+                        if (glContext)
+                            SDL_GL_MakeCurrent(window, glContext);
+                        currentEngineType = GpuMandelbrotCalculator::computeSupported()
+                                                ? GridMandelbrotCalculator::EngineType::GPUC
+                                                : GridMandelbrotCalculator::EngineType::HYBRID;
+                    }
+                    else if (currentEngineType == GridMandelbrotCalculator::EngineType::GPUC)
+                    {
+                        currentEngineType = GridMandelbrotCalculator::EngineType::HYBRID;
+                    }
+                    else if (currentEngineType == GridMandelbrotCalculator::EngineType::HYBRID)
+                    {
+                        currentEngineType = GridMandelbrotCalculator::EngineType::PERTURB;
+                    }
+                    else if (currentEngineType == GridMandelbrotCalculator::EngineType::PERTURB)
+                    {
+                        currentEngineType = GridMandelbrotCalculator::EngineType::PERTURB_SIMD;
+                    }
                     else
                     {
                         currentEngineType = GridMandelbrotCalculator::EngineType::BORDER;
                     }
 
                     // Save current view parameters
-                    double currentCre = calculator->getCre();
-                    double currentCim = calculator->getCim();
+                    BigFloat currentCre = calculator->getPreciseCre();
+                    BigFloat currentCim = calculator->getPreciseCim();
                     double currentDiam = calculator->getDiam();
 
                     // Recreate calculator based on engine type
-                    if (currentEngineType == GridMandelbrotCalculator::EngineType::GPUF ||
-                        currentEngineType == GridMandelbrotCalculator::EngineType::GPUD)
-                    {
-                        // GPU mode always uses 1x1 grid - ensure OpenGL context is ready
-                        auto gridCalc = std::make_unique<GridMandelbrotCalculator>(calcWidth, calcHeight, 1, 1);
-                        gridCalc->setSpeedMode(speedMode);
-                        gridCalc->setEngineType(currentEngineType);
-                        calculator = std::move(gridCalc);
-                    }
-                    else
-                    {
-                        // Restore grid size based on speed mode
-                        int rows = speedMode ? 4 : 1;
-                        int cols = speedMode ? 4 : 1;
-                        auto gridCalc = std::make_unique<GridMandelbrotCalculator>(calcWidth, calcHeight, rows, cols);
-                        gridCalc->setSpeedMode(speedMode);
-                        gridCalc->setEngineType(currentEngineType);
-                        calculator = std::move(gridCalc);
-                    }
+                    createCalculator();
 
-                    calculator->updateBounds(currentCre, currentCim, currentDiam);
+                    calculator->updateBoundsPrecise(currentCre, currentCim, currentDiam);
                     compute();
                     render();
                 }
@@ -805,6 +1112,7 @@ void MandelbrotApp::run()
                         auto newFirst = Gradient::createRandom();
                         mixGradient->transitionToNewFirst(std::move(newFirst));
                         mixGradient->setMixValue(0.0);
+                        ++paletteGeneration;
                         mixAnimating = true;
                     }
                     else
@@ -817,6 +1125,7 @@ void MandelbrotApp::run()
                         auto cycling = std::make_unique<CyclingGradient>(std::move(mix), 0.0);
                         cyclingGradient = cycling.get();
                         gradient = std::move(cycling);
+                        ++paletteGeneration;
                         cyclingActive = false; // Reset cycling when changing palette
                         mixAnimating = false;
                     }
@@ -846,6 +1155,31 @@ void MandelbrotApp::run()
                 {
                     autoZoomActive = !autoZoomActive;
                 }
+                else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_i)
+                {
+                    // Toggle interior checks (same image, compare timings with -v)
+                    setInteriorCheck(!interiorCheck);
+                    std::cout << "Interior checks: " << (interiorCheck ? "ON" : "OFF") << std::endl;
+                    compute();
+                    render();
+                }
+                else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_g)
+                {
+                    setProgressive(!progressive);
+                    std::cout << "Progressive rendering: " << (progressive ? "ON" : "OFF") << std::endl;
+                    compute();
+                    render();
+                }
+                else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_z)
+                {
+                    setIncrementalZoom(!incrementalZoom);
+                    std::cout << "Incremental zoom: " << (incrementalZoom ? "ON" : "OFF") << std::endl;
+                }
+                else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_m)
+                {
+                    setSmoothZoom(!smoothZoom);
+                    std::cout << "Smooth zoom: " << (smoothZoom ? "ON" : "OFF") << std::endl;
+                }
                 else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_x)
                 {
                     int newSize = (pixelSize == 1) ? 10 : 1;
@@ -953,6 +1287,10 @@ void MandelbrotApp::run()
             }
         }
 
+        // Show the progress of the background frame, or finish it
+        pollCompute();
+        updateZoomPlayback();
+
         // Mix animation functionality
         if (mixAnimating)
         {
@@ -976,8 +1314,9 @@ void MandelbrotApp::run()
             render();
         }
 
-        // Auto-zoom functionality
-        if (autoZoomActive)
+        // Auto-zoom functionality (the next step is chosen from a finished
+        // frame, once its transition is over)
+        if (autoZoomActive && !isComputing() && !playbackActive)
         {
             // Check if zoom is disabled, reset to home if so
             if (isZoomDisabled())
@@ -990,6 +1329,7 @@ void MandelbrotApp::run()
                 auto cycling = std::make_unique<CyclingGradient>(std::move(mix), 0.0);
                 cyclingGradient = cycling.get();
                 gradient = std::move(cycling);
+                ++paletteGeneration;
                 cyclingActive = false;
                 mixAnimating = false;
                 resetZoom();
@@ -1005,8 +1345,8 @@ void MandelbrotApp::run()
 
                 // Find an interesting point to zoom to (in calculation coordinates)
                 int calcCenterX, calcCenterY;
-                zoomChooser->findInterestingPoint(calculator->getData(),
-                                                  MandelbrotCalculator::MAX_ITER,
+                zoomChooser->findInterestingPoint(calculator->getCounts(),
+                                                  calculator->getMaxIterations(),
                                                   calcCenterX, calcCenterY,
                                                   calcRectW, calcRectH);
 
@@ -1021,11 +1361,19 @@ void MandelbrotApp::run()
                 int x2 = x1 + rectW;
                 int y2 = y1 + rectH;
 
-                // Blink the rectangle 3 times before zooming
-                blinkRect(x1, y1, rectW, rectH, 3, 150);
+                if (smoothZoom)
+                {
+                    // Zoom into the current frame while the next one computes
+                    startZoomPlayback(x1, y1, x2, y2);
+                }
+                else
+                {
+                    // Blink the rectangle 3 times before zooming
+                    blinkRect(x1, y1, rectW, rectH, 3, 150);
 
-                // Perform the zoom
-                zoomToRect(x1, y1, x2, y2, false);
+                    // Perform the zoom
+                    zoomToRect(x1, y1, x2, y2, false);
+                }
             }
         }
 
@@ -1083,6 +1431,10 @@ void MandelbrotApp::saveScreenshot(const std::string& basename)
         return;
     }
     
+    // The texture's CPU copy is stale after a GPU display pass
+    if (gpuDisplayed)
+        colorizeToTexture();
+
     // Lock texture and read pixels
     void* pixels;
     int pitch;
@@ -1133,6 +1485,114 @@ void MandelbrotApp::saveScreenshot(const std::string& basename)
     }
 }
 
+void MandelbrotApp::dumpIterations(const std::string& basename)
+{
+    std::string filename;
+    try
+    {
+        filename = generateUniqueFilename(basename, ".mbi");
+    }
+    catch (const std::runtime_error& e)
+    {
+        std::cerr << "Failed to generate unique filename: " << e.what() << std::endl;
+        return;
+    }
+
+    // The header describes the view being computed: dump that frame once it
+    // is complete, not the buffer half way through
+    if (isComputing())
+    {
+        std::cout << "Waiting for the frame to finish before saving iterations" << std::endl;
+        waitForCompute();
+        render();
+    }
+
+    // May read the frame back from the GPU
+    const IterationCount *counts = calculator->getCounts();
+    IterationFileHeader header = IterationFileHeader::describe(*calculator, calcWidth, calcHeight);
+    IterationFileWriter writer;
+    if (writer.open(filename, header) && writer.writeRows(counts, calcHeight) && writer.close())
+    {
+        std::cout << "Iterations saved: " << filename << std::endl;
+    }
+    else
+    {
+        std::cerr << "Failed to save iterations: " << filename << std::endl;
+    }
+}
+
+bool MandelbrotApp::loadIterations(const std::string &path)
+{
+    auto file = std::make_unique<MappedIterationFile>();
+    if (!file->open(path))
+        return false;
+    if (file->header().width != calcWidth || file->header().height != calcHeight)
+    {
+        std::cerr << path << " is " << file->header().width << "x" << file->header().height
+                  << ", the window computes " << calcWidth << "x" << calcHeight << std::endl;
+        return false;
+    }
+
+    cancelCompute();
+    endZoomPlayback();
+    previousFrame.data.clear();
+    calculator = std::make_unique<MappedMandelbrotCalculator>(std::move(file));
+    calculator->setCancelFlag(&cancelRequested);
+    maxIterations = calculator->getMaxIterations(); // The engine goes on with the file's limit
+    fileLoaded = true;
+
+    // Shown as a finished frame: colorized, recorded, searched by auto-zoom
+    computeStart = computeEnd = std::chrono::high_resolution_clock::now();
+    finishCompute();
+    std::cout << "Loaded: " << path << std::endl;
+    return true;
+}
+
+bool MandelbrotApp::startRecording(const std::string &path)
+{
+    stopRecording();
+    recorder = std::make_unique<FrameRecorder>();
+    if (!recorder->open(path, calcWidth, calcHeight))
+    {
+        recorder.reset();
+        return false;
+    }
+    recordedSerial = imageSerial - 1; // The current frame, once finished
+    std::cout << "Recording: " << path << std::endl;
+    return true;
+}
+
+void MandelbrotApp::stopRecording()
+{
+    if (!recorder)
+        return;
+
+    // Waits for the frames still queued
+    bool saved = recorder->close();
+    std::cout << (saved ? "Recording saved: " : "Recording failed: ") << recorder->getPath()
+              << " (" << recorder->getFramesWritten() << " frames, " << recorder->getFramesDropped() << " dropped)" << std::endl;
+    recorder.reset();
+}
+
+void MandelbrotApp::recordFrame()
+{
+    recordedSerial = imageSerial;
+
+    // A recording that cannot be written (ffmpeg gone) ends at once
+    if (recorder->hasFailed())
+    {
+        stopRecording();
+        return;
+    }
+
+    // When the encoder is behind, the frame is dropped rather than waited for
+    Uint32 *pixels = recorder->acquire();
+    if (!pixels)
+        return;
+    colorizeInto(pixels, calcWidth * 4);
+    recorder->submit();
+}
+
 void MandelbrotApp::setVerboseMode(bool verbose)
 {
     verboseMode = verbose;
@@ -1146,6 +1606,57 @@ void MandelbrotApp::setAutoZoom(bool enabled)
     autoZoomActive = enabled;
 }
 
+void MandelbrotApp::setInteriorCheck(bool enabled)
+{
+    cancelCompute();
+    interiorCheck = enabled;
+    calculator->setInteriorCheck(enabled);
+}
+
+void MandelbrotApp::setMaxIterations(int maxIter)
+{
+    cancelCompute();
+    calculator->setMaxIterations(maxIter);
+    maxIterations = calculator->getMaxIterations(); // Clamped to the supported range
+}
+
+void MandelbrotApp::setIncrementalZoom(bool enabled)
+{
+    incrementalZoom = enabled;
+    if (!enabled)
+        previousFrame.data.clear();
+}
+
+void MandelbrotApp::setSmoothZoom(bool enabled)
+{
+    smoothZoom = enabled;
+    if (!enabled)
+        endZoomPlayback();
+}
+
+void MandelbrotApp::setProgressive(bool enabled)
+{
+    if (progressive == enabled)
+        return;
+
+    // Save current view parameters
+    BigFloat currentCre = calculator->getPreciseCre();
+    BigFloat currentCim = calculator->getPreciseCim();
+    double currentDiam = calculator->getDiam();
+
+    progressive = enabled;
+    createCalculator();
+    calculator->updateBoundsPrecise(currentCre, currentCim, currentDiam);
+}
+
+void MandelbrotApp::setAdaptiveIterations(bool enabled)
+{
+    if (enabled)
+        iterationPolicy = std::make_unique<IterationPolicy>(128, MandelbrotCalculator::MAX_ITER_LIMIT);
+    else
+        iterationPolicy.reset();
+}
+
 void MandelbrotApp::setRandomPalette()
 {
     // Maintain structure: cycling -> mix -> (first, second)
@@ -1156,6 +1667,7 @@ void MandelbrotApp::setRandomPalette()
     auto cycling = std::make_unique<CyclingGradient>(std::move(mix), 0.0);
     cyclingGradient = cycling.get();
     gradient = std::move(cycling);
+    ++paletteGeneration;
     cyclingActive = false;
     mixAnimating = false;
 }
@@ -1,13 +1,20 @@
 #pragma once
 
 #include <SDL2/SDL.h>
+#include <atomic>
+#include <chrono>
 #include <vector>
 #include <memory>
 #include <string>
+#include <thread>
 #include "mandelbrot_calculator.h"
 #include "grid_mandelbrot_calculator.h"
 #include "zoom_point_chooser.h"
+#include "iteration_policy.h"
+#include "frame_snapshot.h"
+#include "progressive_mandelbrot_calculator.h"
 #include "gradient.h"
+#include "frame_recorder.h"
 
 class MandelbrotApp
 {
@@ -21,6 +28,16 @@ public:
     void setAutoZoom(bool enabled);
     void setRandomPalette();
     void setPixelSize(int size);
+    void setInteriorCheck(bool enabled);
+    void setMaxIterations(int maxIter);
+    void setAdaptiveIterations(bool enabled);
+    void setIncrementalZoom(bool enabled);
+    void setProgressive(bool enabled);
+    void setSmoothZoom(bool enabled);
+    bool startRecording(const std::string &path);
+    // Shows a frame dumped at the window's computed size (.mbi) instead of
+    // computing the first one
+    bool loadIterations(const std::string &path);
 
 private:
     int width;
@@ -34,9 +51,20 @@ private:
     SDL_Texture *texture;
     SDL_GLContext glContext; // OpenGL context for GPU rendering
     bool ownsGLContext;      // Whether we own the context and should delete it
+    unsigned displayTextureId; // GL name of texture (0 if the renderer is not OpenGL)
+    bool gpuDisplayed;         // texture was colorized on the GPU, its CPU copy is stale
+
+    // ARGB color of each iteration count of the current frame. It is only
+    // rebuilt when one of the values it was baked from changes.
+    std::vector<uint32_t> palette;
+    unsigned paletteGeneration; // Bumped whenever the gradient tree is replaced
+    unsigned bakedGeneration;
+    double bakedOffset;
+    double bakedMix;
 
     std::unique_ptr<MandelbrotCalculator> calculator;
     std::unique_ptr<ZoomPointChooser> zoomChooser;
+    std::unique_ptr<IterationPolicy> iterationPolicy; // Null when the limit is fixed
     std::unique_ptr<Gradient> gradient;
     CyclingGradient* cyclingGradient; // Pointer to the cycling gradient wrapper (not owned)
     MixGradient* mixGradient; // Pointer to the mix gradient wrapper (not owned)
@@ -49,26 +77,81 @@ private:
     bool cyclingActive;
     double cyclingStep; // +0.01 for forward, -0.01 for reverse
     bool mixAnimating;
+    bool interiorCheck; // Cardioid/bulb and periodicity checks in the CPU engines
+    int maxIterations;  // Iteration limit of the current view
+    bool incrementalZoom; // Zooms reuse the pixels of the previous frame
+    FrameSnapshot previousFrame; // Frame before the last zoom, until the next compute
+    bool progressive;     // Coarse to fine rendering (CPU engines)
+
+    // Smooth zoom (auto-zoom): the finished frame stays on screen, scaled by
+    // the renderer towards the chosen region, while the next frame computes
+    // into the other texture. The next frame is shown once both are done.
+    bool smoothZoom;
+    bool playbackActive;
+    SDL_Texture *playbackTexture; // The frame being zoomed into (created on first use)
+    SDL_Rect playbackRect;        // Its region the next frame shows (window coordinates)
+    double playbackMs;            // Duration of the transition
+    std::chrono::high_resolution_clock::time_point playbackStart;
+    static constexpr double SMOOTH_ZOOM_MS = 1500.0;
+
+    // Recording (Shift+R): every finished image, a completed frame or a new
+    // palette over it, is copied to the recorder, which encodes it on its
+    // own thread. The progress of a frame is not recorded.
+    std::unique_ptr<FrameRecorder> recorder;
+    unsigned imageSerial;    // Bumped when a frame completes or the palette is re-baked
+    unsigned recordedSerial; // imageSerial of the last recorded image
+
+    // Background compute (CPU engines). The event loop keeps running: it
+    // renders when the frame was updated and finishes it once done. A new
+    // view cancels the frame in flight.
+    std::thread computeThread;
+    std::atomic<bool> cancelRequested;
+    std::atomic<bool> computeFinished;
+    std::atomic<bool> frameUpdated;
+    std::chrono::high_resolution_clock::time_point computeStart, computeEnd;
+    bool frameComplete; // The calculator holds a finished frame
+    bool fileLoaded;    // The calculator is a loaded file, which the engine replaces on the next compute
     GridMandelbrotCalculator::EngineType currentEngineType;
 
+    // Tiles per side of the speed mode grid
+    static constexpr int SPEED_GRID_SIZE = 8;
+
     void initSDL();
     void switchToOpenGL();
     void switchToSDLRenderer();
     void createCalculator();
     void render();
-    void compute(); // Helper to handle context switching
+    void present(); // Draws the texture (or the zoom transition) to the window
+    void bakePalette(int maxIter);
+    void colorizeToTexture();
+    void colorizeInto(Uint32 *pixels, int pitch); // pitch in bytes
+    void updateDisplayTextureId();
+    void compute(); // Starts the frame (in the background for CPU engines)
+    void cancelCompute();
+    void waitForCompute();
+    void pollCompute();
+    void finishCompute();
+    bool isComputing() const { return computeThread.joinable(); }
     void handleResize(int newWidth, int newHeight);
 
     // Interaction helpers
     SDL_Rect calculateSelectionRect(int startX, int startY, int endX, int endY, bool centerBased);
     void zoomToRegion(int x1, int y1, int x2, int y2);
+    void moveView(double offsetR, double offsetI, double newDiam); // Center moved by an offset
     void zoomToRect(int x1, int y1, int x2, int y2, bool inverse = false);
     void animateRectToRect(int startX, int startY, int startWidth, int startHeight,
                            int endX, int endY, int endWidth, int endHeight,
                            int steps = 15, int frameDelay = 16);
     void blinkRect(int x, int y, int w, int h, int times = 3, int blinkDelay = 150);
+    void startZoomPlayback(int x1, int y1, int x2, int y2);
+    void updateZoomPlayback();
+    void endZoomPlayback();
+    void releasePlaybackTexture();
     void resetZoom();
     bool isZoomDisabled() const;
     void saveScreenshot(const std::string &basename = "mandelbrot");
+    void dumpIterations(const std::string &basename = "mandelbrot");
+    void recordFrame();
+    void stopRecording();
     std::string generateUniqueFilename(const std::string &basename, const std::string &extension);
 };
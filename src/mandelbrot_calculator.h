@@ -1,9 +1,46 @@
 #pragma once
 
+#include "calculator_stats.h"
+#include "big_float.h"
+#include <atomic>
+#include <cstdint>
 #include <vector>
 #include <functional>
 #include <string>
 
+// Iteration count of one pixel. 16 bits cover MAX_ITER_LIMIT and halve the
+// memory and cache traffic of the frame buffers compared to int.
+using IterationCount = uint16_t;
+
+// A frame is shown while it is computed: the event loop colorizes the
+// counts an engine is still writing. Engines write their output through
+// these, and a frame in progress is read through them: relaxed atomic
+// accesses, plain moves on the supported targets, so a pixel is read as
+// either its old or its new count.
+inline IterationCount loadCount(const IterationCount &count)
+{
+    return std::atomic_ref<IterationCount>(const_cast<IterationCount &>(count)).load(std::memory_order_relaxed);
+}
+
+inline void storeCount(IterationCount &count, IterationCount value)
+{
+    std::atomic_ref<IterationCount>(count).store(value, std::memory_order_relaxed);
+}
+
+inline void storeCounts(IterationCount *dst, const IterationCount *src, int count)
+{
+    for (int i = 0; i < count; ++i)
+        storeCount(dst[i], src[i]);
+}
+
+inline void fillCounts(IterationCount *dst, int count, IterationCount value)
+{
+    for (int i = 0; i < count; ++i)
+        storeCount(dst[i], value);
+}
+
+struct FrameSnapshot;
+
 // Abstract base class for Mandelbrot set calculators
 class MandelbrotCalculator
 {
@@ -16,11 +53,28 @@ public:
     virtual void compute(std::function<void()> progressCallback) = 0;
     virtual void reset() = 0;
 
+    // Incremental recomputation, for the next compute() only: pixels of the
+    // previous frame that lie exactly on the new samples are taken as they
+    // are (when the iteration limit is unchanged) and the others show the
+    // nearest old pixel as a preview until they are computed. Engines that
+    // cannot reuse pixels ignore it.
+    virtual void seed(const FrameSnapshot & /*previous*/) {}
+
     // Data access
-    virtual const std::vector<int> &getData() const = 0;
+    virtual const std::vector<IterationCount> &getData() const = 0;
+    // The same width * height counts, rows top to bottom, for readers that
+    // only need a pointer: a frame that is not held in a vector (a mapped
+    // file) is then used in place instead of copied into one
+    virtual const IterationCount *getCounts() const { return getData().data(); }
     virtual int getWidth() const = 0;
     virtual int getHeight() const = 0;
 
+    // Render into a strided view of a caller's buffer: pixel (x, y) goes to
+    // base[y * pitch + x], and getData() is no longer meaningful. A null
+    // base goes back to an own buffer. Returns false if the engine cannot
+    // (it keeps its own buffer, read with getData()).
+    virtual bool setOutput(IterationCount * /*base*/, int /*pitch*/) { return false; }
+
     // View parameters
     virtual double getCre() const = 0;
     virtual double getCim() const = 0;
@@ -30,16 +84,53 @@ public:
     virtual double getStepR() const = 0;
     virtual double getStepI() const = 0;
 
+    // Deep zoom: the view center to more bits than a double holds. Engines
+    // limited to doubles take its rounding (and report it back).
+    virtual void updateBoundsPrecise(const BigFloat &cre, const BigFloat &cim, double diam) { updateBounds(cre.toDouble(), cim.toDouble(), diam); }
+    virtual BigFloat getPreciseCre() const { return BigFloat(getCre()); }
+    virtual BigFloat getPreciseCim() const { return BigFloat(getCim()); }
+
+    // Smallest view diameter the engine still renders as distinct pixels
+    virtual double getMinDiam() const { return 1e-15; }
+
+    // Replaces the escape time loop of the border and SIMD engines:
+    // kernel(cr, ci, out, count, maxIter) sets out[k] for the view points
+    // (cr[k], ci[k]), so another engine can reuse their traversal with its
+    // own arithmetic (perturbation). Empty restores the engine's own loop.
+    using PointKernel = std::function<void(const double *, const double *, IterationCount *, int, int)>;
+    virtual void setPointKernel(const PointKernel & /*kernel*/) {}
+
     // Configuration
     virtual void setSpeedMode(bool mode) = 0;
     virtual bool getSpeedMode() const = 0;
+
+    // Interior checks (CPU engines): cardioid/bulb test and periodicity
+    // detection. Results are the same, only faster on interior points.
+    virtual void setInteriorCheck(bool enabled) = 0;
+    virtual bool getInteriorCheck() const = 0;
+
+    // Iteration limit (points that reach it are drawn as interior)
+    virtual void setMaxIterations(int maxIter) = 0;
+    virtual int getMaxIterations() const = 0;
+
+    // Cancellation: compute() returns early, leaving a partial frame, once
+    // *flag is set (from any thread). Null disables it.
+    virtual void setCancelFlag(const std::atomic<bool> *flag) = 0;
     
     // Engine identification for verbose output
     virtual std::string getEngineName() const = 0;
 
-    // Rendering (for GPU implementations)
+    // Counters of the last compute()
+    virtual const CalculatorStats &getStats() const = 0;
+
+    // Rendering (for GPU implementations): colorize the last frame without
+    // reading it back. palette holds one ARGB color per iteration count
+    // (0..maxIter); targetTexture is the GL name of the display texture.
     virtual bool hasOwnOutput() const { return false; }
-    virtual void render() {}
+    virtual void setPalette(const std::vector<uint32_t> & /*palette*/) {}
+    virtual void render(unsigned /*targetTexture*/) {}
 
+    // Default iteration limit, and the highest one an IterationCount holds
     static constexpr int MAX_ITER = 768;
+    static constexpr int MAX_ITER_LIMIT = 65535;
 };
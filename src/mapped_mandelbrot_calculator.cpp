@@ -0,0 +1,36 @@
+#include "mapped_mandelbrot_calculator.h"
+#include <algorithm>
+
+MappedMandelbrotCalculator::MappedMandelbrotCalculator(std::unique_ptr<MappedIterationFile> mappedFile)
+    : ZoomMandelbrotCalculator(mappedFile->header().width, mappedFile->header().height), file(std::move(mappedFile))
+{
+    // The bounds as written, not derived again from the center
+    const IterationFileHeader &header = file->header();
+    cre = header.cre;
+    cim = header.cim;
+    diam = header.diam;
+    minr = header.minR;
+    mini = header.minI;
+    stepr = header.stepR;
+    stepi = header.stepI;
+    maxr = minr + width * stepr;
+    maxi = mini + height * stepi;
+    maxIter = std::clamp<int>(header.maxIter, 1, MAX_ITER_LIMIT);
+}
+
+void MappedMandelbrotCalculator::compute(std::function<void()> progressCallback)
+{
+    // Nothing to compute: the frame is the file's
+    stats.clear();
+    if (progressCallback)
+        progressCallback();
+}
+
+const std::vector<IterationCount> &MappedMandelbrotCalculator::getData() const
+{
+    std::call_once(dataCopied, [this]()
+                   {
+        const IterationCount *counts = file->counts();
+        data.assign(counts, counts + static_cast<size_t>(width) * height); });
+    return data;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "zoom_mandelbrot_calculator.h"
+#include "iteration_file.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// A frame loaded from an iteration file (.mbi), shown and searched for zoom
+// points as if it had been computed: the size, view and iteration limit are
+// the file's, and compute() has nothing to do. It cannot draw another view;
+// a caller that moves it hands the new view to an engine.
+class MappedMandelbrotCalculator : public ZoomMandelbrotCalculator
+{
+public:
+    explicit MappedMandelbrotCalculator(std::unique_ptr<MappedIterationFile> file);
+
+    void compute(std::function<void()> progressCallback) override;
+    void reset() override {}
+
+    // The limit the file was computed with
+    void setMaxIterations(int /*maxIter*/) override {}
+
+    // The counts in place in the mapping
+    const IterationCount *getCounts() const override { return file->counts(); }
+
+    // Only for readers that need a vector: the mapped counts are copied
+    // into one on first access (from any thread)
+    const std::vector<IterationCount> &getData() const override;
+
+    std::string getEngineName() const override { return " file"; }
+
+private:
+    std::unique_ptr<MappedIterationFile> file;
+    mutable std::vector<IterationCount> data;
+    mutable std::once_flag dataCopied;
+};
@@ -0,0 +1,175 @@
+#include "progressive_mandelbrot_calculator.h"
+#include <algorithm>
+
+ProgressiveMandelbrotCalculator::ProgressiveMandelbrotCalculator(int w, int h, const Factory &factory)
+    : StorageMandelbrotCalculator(w, h)
+{
+    for (int scale : {8, 4, 2, 1})
+    {
+        int levelWidth = (width + scale - 1) / scale;
+        int levelHeight = (height + scale - 1) / scale;
+        levels.push_back({scale, levelWidth, levelHeight, factory(levelWidth, levelHeight)});
+    }
+
+    // The full resolution level draws straight into this calculator's output
+    levels.back().calculator->setOutput(out, pitch);
+}
+
+bool ProgressiveMandelbrotCalculator::setOutput(IterationCount *base, int newPitch)
+{
+    StorageMandelbrotCalculator::setOutput(base, newPitch);
+    levels.back().calculator->setOutput(out, pitch);
+    return true;
+}
+
+void ProgressiveMandelbrotCalculator::reset()
+{
+    StorageMandelbrotCalculator::reset();
+    for (auto &level : levels)
+        level.calculator->reset();
+}
+
+void ProgressiveMandelbrotCalculator::seed(const FrameSnapshot &previous)
+{
+    // The previous frame seeds the first level; the next levels are seeded
+    // from their coarser level
+    levels.front().calculator->seed(previous);
+}
+
+void ProgressiveMandelbrotCalculator::setSpeedMode(bool mode)
+{
+    StorageMandelbrotCalculator::setSpeedMode(mode);
+    for (auto &level : levels)
+        level.calculator->setSpeedMode(mode);
+}
+
+void ProgressiveMandelbrotCalculator::setInteriorCheck(bool enabled)
+{
+    StorageMandelbrotCalculator::setInteriorCheck(enabled);
+    for (auto &level : levels)
+        level.calculator->setInteriorCheck(enabled);
+}
+
+void ProgressiveMandelbrotCalculator::setMaxIterations(int newMaxIter)
+{
+    StorageMandelbrotCalculator::setMaxIterations(newMaxIter);
+    for (auto &level : levels)
+        level.calculator->setMaxIterations(maxIter);
+}
+
+void ProgressiveMandelbrotCalculator::setCancelFlag(const std::atomic<bool> *flag)
+{
+    StorageMandelbrotCalculator::setCancelFlag(flag);
+    for (auto &level : levels)
+        level.calculator->setCancelFlag(flag);
+}
+
+void ProgressiveMandelbrotCalculator::compute(std::function<void()> progressCallback)
+{
+    stats.clear();
+    for (size_t i = 0; i < levels.size(); ++i)
+    {
+        Level &level = levels[i];
+
+        // Level samples are every scale-th full resolution sample
+        level.calculator->updateBoundsExplicit(minr, mini,
+                                               minr + level.width * level.scale * stepr,
+                                               mini + level.height * level.scale * stepi);
+        if (i > 0)
+            refine(levels[i - 1], level);
+
+        // The work of all levels adds up; the interior is the one of the
+        // finest level computed
+        if (level.scale == 1)
+        {
+            level.calculator->compute(progressCallback);
+            addLevelStats(level);
+            break;
+        }
+
+        level.calculator->compute(nullptr);
+        addLevelStats(level);
+        if (isCancelled())
+            break;
+        showLevel(level);
+        if (progressCallback)
+            progressCallback();
+    }
+
+    endSeed();
+}
+
+void ProgressiveMandelbrotCalculator::refine(const Level &coarse, const Level &fine)
+{
+    // Spread the coarse level on the samples of the fine one: even samples
+    // are coarse samples, the others lie between 2 or 4 of them. When those
+    // agree the sample takes their value; otherwise it only gets a preview
+    // and is computed.
+    const auto &src = coarse.calculator->getData();
+    const MandelbrotCalculator &target = *fine.calculator;
+
+    refined.width = fine.width;
+    refined.height = fine.height;
+    refined.minR = target.getMinR();
+    refined.minI = target.getMinI();
+    refined.stepR = target.getStepR();
+    refined.stepI = target.getStepI();
+    refined.maxIter = maxIter;
+    refined.data.resize(fine.width * fine.height);
+    refined.valid.resize(fine.width * fine.height);
+
+    for (int y = 0; y < fine.height; ++y)
+    {
+        int y0 = std::min(y / 2, coarse.height - 1);
+        int y1 = std::min((y + 1) / 2, coarse.height - 1);
+
+        // Past the last coarse row (or column) the indices are clamped onto
+        // the same coarse samples: those agree with themselves, and say
+        // nothing about the sample, which is computed
+        bool rowInside = (y + 1) / 2 < coarse.height;
+
+        for (int x = 0; x < fine.width; ++x)
+        {
+            int x0 = std::min(x / 2, coarse.width - 1);
+            int x1 = std::min((x + 1) / 2, coarse.width - 1);
+            bool inside = rowInside && (x + 1) / 2 < coarse.width;
+
+            IterationCount value = src[y0 * coarse.width + x0];
+            bool agree = src[y0 * coarse.width + x1] == value &&
+                         src[y1 * coarse.width + x0] == value &&
+                         src[y1 * coarse.width + x1] == value;
+
+            refined.data[y * fine.width + x] = value;
+            refined.valid[y * fine.width + x] = inside && agree;
+        }
+    }
+
+    fine.calculator->seed(refined);
+}
+
+void ProgressiveMandelbrotCalculator::showLevel(const Level &level)
+{
+    // Each sample covers a scale x scale block of the output: expand the
+    // first row of each block, then copy it down
+    const auto &src = level.calculator->getData();
+    for (int y = 0; y < height; y += level.scale)
+    {
+        const IterationCount *row = &src[(y / level.scale) * level.width];
+        IterationCount *dst = &at(0, y);
+        for (int sx = 0; sx < level.width; ++sx)
+        {
+            int x = sx * level.scale;
+            fillCounts(dst + x, std::min(level.scale, width - x), row[sx]);
+        }
+
+        for (int dy = 1; dy < level.scale && y + dy < height; ++dy)
+            storeCounts(&at(0, y + dy), dst, width);
+    }
+}
+
+void ProgressiveMandelbrotCalculator::addLevelStats(const Level &level)
+{
+    const CalculatorStats &levelStats = level.calculator->getStats();
+    stats.add(levelStats);
+    stats.interiorPixels = levelStats.interiorPixels;
+}
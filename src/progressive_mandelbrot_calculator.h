@@ -0,0 +1,48 @@
+#pragma once
+
+#include "storage_mandelbrot_calculator.h"
+#include "frame_snapshot.h"
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Coarse to fine rendering on top of any engine: the frame is computed at
+// 1/8, 1/4, 1/2 and full resolution, and displayed after each level.
+// Each level reuses the samples of the previous one (every other sample of
+// a level is a sample of the coarser level) and skips the blocks whose four
+// coarse corners agree, taking their value like border tracing does.
+class ProgressiveMandelbrotCalculator : public StorageMandelbrotCalculator
+{
+public:
+    // Creates the calculator of one level
+    using Factory = std::function<std::unique_ptr<MandelbrotCalculator>(int width, int height)>;
+
+    ProgressiveMandelbrotCalculator(int width, int height, const Factory &factory);
+
+    void compute(std::function<void()> progressCallback) override;
+    void reset() override;
+    bool setOutput(IterationCount *base, int pitch) override;
+    void seed(const FrameSnapshot &previous) override;
+
+    void setSpeedMode(bool mode) override;
+    void setInteriorCheck(bool enabled) override;
+    void setMaxIterations(int maxIter) override;
+    void setCancelFlag(const std::atomic<bool> *flag) override;
+
+    std::string getEngineName() const override { return levels.back().calculator->getEngineName() + " prog"; }
+
+private:
+    struct Level
+    {
+        int scale; // Full resolution pixels per sample
+        int width, height;
+        std::unique_ptr<MandelbrotCalculator> calculator;
+    };
+    std::vector<Level> levels; // Coarsest first, the last one is full resolution
+
+    FrameSnapshot refined; // Previous level spread on the samples of the next one
+
+    void refine(const Level &coarse, const Level &fine);
+    void showLevel(const Level &level);
+    void addLevelStats(const Level &level);
+};
@@ -0,0 +1,222 @@
+#include "reference_orbit.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace
+{
+    // Relative difference between the series and direct iteration still
+    // taken as a match
+    const double SERIES_TOLERANCE = 1e-13;
+
+    // Probes of the series: a lattice over the view, corners included
+    const int PROBE_LATTICE = 5;
+}
+
+bool ReferenceOrbit::compute(const BigFloat &newCre, const BigFloat &newCim, double diam, int newMaxIter, const std::atomic<bool> *cancelFlag)
+{
+    int newPrecision = BigFloat::limbsFor(diam);
+    if (!zr.empty() && newMaxIter == maxIter && newPrecision <= precision && newCre == cre && newCim == cim)
+    {
+        milliseconds = 0.0;
+        return true;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    BigFloat cr = newCre.withPrecision(newPrecision);
+    BigFloat ci = newCim.withPrecision(newPrecision);
+    BigFloat x(0.0, newPrecision), y(0.0, newPrecision);
+
+    zr.assign(1, 0.0);
+    zi.assign(1, 0.0);
+    zr.reserve(newMaxIter + 1);
+    zi.reserve(newMaxIter + 1);
+    for (int n = 0; n < newMaxIter; ++n)
+    {
+        if ((n & 1023) == 0 && cancelFlag && cancelFlag->load(std::memory_order_relaxed))
+        {
+            zr.clear();
+            zi.clear();
+            return false;
+        }
+
+        BigFloat xx = x * x;
+        BigFloat yy = y * y;
+        BigFloat xy = x * y;
+        x = xx - yy + cr; // Z = Z^2 + C
+        y = xy + xy + ci;
+
+        double r = x.toDouble();
+        double i = y.toDouble();
+        zr.push_back(r);
+        zi.push_back(i);
+        if (r * r + i * i >= 4.0)
+            break;
+    }
+
+    skip = 0;
+    seriesHalfWidth = seriesHalfHeight = -1.0;
+    cre = newCre;
+    cim = newCim;
+    precision = newPrecision;
+    maxIter = newMaxIter;
+    milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+void ReferenceOrbit::approximate(double halfWidth, double halfHeight)
+{
+    if (halfWidth == seriesHalfWidth && halfHeight == seriesHalfHeight)
+        return;
+
+    auto start = std::chrono::steady_clock::now();
+    seriesHalfWidth = halfWidth;
+    seriesHalfHeight = halfHeight;
+    seriesRadius = std::hypot(halfWidth, halfHeight);
+    skip = 0;
+    const int last = getLength() - 1;
+    if (!(seriesRadius > 0.0))
+        return;
+
+    constexpr int PROBES = PROBE_LATTICE * PROBE_LATTICE;
+    double probeR[PROBES], probeI[PROBES]; // dc
+    double unitR[PROBES], unitI[PROBES];   // dc / radius
+    double directR[PROBES] = {}, directI[PROBES] = {};
+    for (int a = 0; a < PROBE_LATTICE; ++a)
+    {
+        for (int b = 0; b < PROBE_LATTICE; ++b)
+        {
+            int p = a * PROBE_LATTICE + b;
+            probeR[p] = (2.0 * a / (PROBE_LATTICE - 1) - 1.0) * halfWidth;
+            probeI[p] = (2.0 * b / (PROBE_LATTICE - 1) - 1.0) * halfHeight;
+            unitR[p] = probeR[p] / seriesRadius;
+            unitI[p] = probeI[p] / seriesRadius;
+        }
+    }
+
+    // Coefficient k of d(n), for the power k + 1 of dc / radius. From
+    // d(n + 1) = 2 Z(n) d(n) + d(n)^2 + dc:
+    // a(k, n + 1) = 2 Z(n) a(k, n) + sum of a(i, n) a(j, n) over the powers
+    // adding up to k + 1, plus the radius for the linear term
+    double ar[SERIES_TERMS] = {}, ai[SERIES_TERMS] = {};
+    for (int n = 0; n + 1 < last; ++n)
+    {
+        const double r = zr[n], i = zi[n];
+        double nextR[SERIES_TERMS], nextI[SERIES_TERMS];
+        for (int k = 0; k < SERIES_TERMS; ++k)
+        {
+            double tr = 2.0 * (r * ar[k] - i * ai[k]);
+            double ti = 2.0 * (r * ai[k] + i * ar[k]);
+            for (int l = 0; l < k; ++l)
+            {
+                int m = k - 1 - l;
+                tr += ar[l] * ar[m] - ai[l] * ai[m];
+                ti += ar[l] * ai[m] + ai[l] * ar[m];
+            }
+            nextR[k] = tr;
+            nextI[k] = ti;
+        }
+        nextR[0] += seriesRadius;
+        std::copy_n(nextR, SERIES_TERMS, ar);
+        std::copy_n(nextI, SERIES_TERMS, ai);
+
+        // Every probe must still match, and neither escape nor need a
+        // rebase before the iterations the series will skip
+        bool valid = true;
+        for (int p = 0; p < PROBES && valid; ++p)
+        {
+            double dr = directR[p], di = directI[p];
+            directR[p] = 2.0 * (r * dr - i * di) + (dr * dr - di * di) + probeR[p];
+            directI[p] = 2.0 * (r * di + i * dr) + 2.0 * dr * di + probeI[p];
+            dr = directR[p];
+            di = directI[p];
+
+            double sr = ar[SERIES_TERMS - 1], si = ai[SERIES_TERMS - 1];
+            for (int k = SERIES_TERMS - 2; k >= 0; --k)
+            {
+                double tr = sr * unitR[p] - si * unitI[p] + ar[k];
+                si = sr * unitI[p] + si * unitR[p] + ai[k];
+                sr = tr;
+            }
+            double tr = sr * unitR[p] - si * unitI[p];
+            si = sr * unitI[p] + si * unitR[p];
+            sr = tr;
+
+            double pixelR = zr[n + 1] + dr;
+            double pixelI = zi[n + 1] + di;
+            double magnitude = pixelR * pixelR + pixelI * pixelI;
+            double offset = dr * dr + di * di;
+            double error = (sr - dr) * (sr - dr) + (si - di) * (si - di);
+            valid = magnitude < 4.0 && magnitude >= offset && error <= SERIES_TOLERANCE * SERIES_TOLERANCE * offset;
+        }
+        if (!valid)
+            break;
+
+        skip = n + 1;
+        std::copy_n(ar, SERIES_TERMS, seriesR);
+        std::copy_n(ai, SERIES_TERMS, seriesI);
+    }
+
+    milliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void ReferenceOrbit::iterate(const double *dcr, const double *dci, IterationCount *out, int count, int limit) const
+{
+    const double *refR = zr.data();
+    const double *refI = zi.data();
+    const int last = getLength() - 1;
+
+    const int start = skip < limit ? skip : 0;
+
+    for (int k = 0; k < count; ++k)
+    {
+        const double cr = dcr[k];
+        const double ci = dci[k];
+        double dr = 0.0, di = 0.0; // z(0) = Z(0) = 0
+        int m = start;             // Index in the reference
+
+        if (start > 0)
+        {
+            // d(skip) from the series in dc / radius
+            double ur = cr / seriesRadius, ui = ci / seriesRadius;
+            dr = seriesR[SERIES_TERMS - 1];
+            di = seriesI[SERIES_TERMS - 1];
+            for (int t = SERIES_TERMS - 2; t >= 0; --t)
+            {
+                double tr = dr * ur - di * ui + seriesR[t];
+                di = dr * ui + di * ur + seriesI[t];
+                dr = tr;
+            }
+            double tr = dr * ur - di * ui;
+            di = dr * ui + di * ur;
+            dr = tr;
+        }
+
+        // Iteration n computes z(n + 1), the value the plain loop tests at n
+        int n;
+        for (n = start; n < limit; ++n)
+        {
+            double r = refR[m], i = refI[m];
+            double ndr = 2.0 * (r * dr - i * di) + (dr * dr - di * di) + cr;
+            double ndi = 2.0 * (r * di + i * dr) + 2.0 * dr * di + ci;
+            dr = ndr;
+            di = ndi;
+            ++m;
+
+            double pixelR = refR[m] + dr;
+            double pixelI = refI[m] + di;
+            double magnitude = pixelR * pixelR + pixelI * pixelI;
+            if (magnitude >= 4.0)
+                break;
+
+            // Rebase: z is now closer to 0 than to the reference
+            if (magnitude < dr * dr + di * di || m == last)
+            {
+                dr = pixelR;
+                di = pixelI;
+                m = 0;
+            }
+        }
+        out[k] = static_cast<IterationCount>(n);
+    }
+}
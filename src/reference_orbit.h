@@ -0,0 +1,56 @@
+#pragma once
+
+#include "big_float.h"
+#include "mandelbrot_calculator.h"
+#include <atomic>
+#include <vector>
+
+// Perturbation: one orbit of the view center in high precision, and the
+// pixels iterated in doubles as offsets from it, which stay representable
+// far below the 1e-15 where plain doubles run out of bits.
+//
+// With Z the reference and z = Z + d a pixel, d(n+1) = 2 Z(n) d(n) + d(n)^2 + dc.
+// When |z| gets smaller than |d| (or the reference ends) the offset would
+// lose precision: the pixel is rebased on the start of the orbit (d = z),
+// so glitches are corrected as they appear instead of being detected afterwards.
+class ReferenceOrbit
+{
+public:
+    // Orbit of (cre, cim) with enough precision for a view of diameter diam,
+    // until it escapes or reaches maxIter. Kept if nothing changed.
+    // Returns false when canceled (the orbit is then recomputed next time).
+    bool compute(const BigFloat &cre, const BigFloat &cim, double diam, int maxIter, const std::atomic<bool> *cancelFlag);
+
+    // Series approximation: over the view |dcr| <= halfWidth, |dci| <= halfHeight,
+    // the offsets of the first iterations are nearly the same polynomial of dc
+    // for every pixel. Finds the last iteration where the polynomial still
+    // matches direct iteration at probe points across the view (none escaped
+    // or needed a rebase), with its coefficients; iterate() then starts every
+    // pixel there. Call after compute(); kept if nothing changed.
+    void approximate(double halfWidth, double halfHeight);
+
+    // Escape counts of the points center + (dcr[k], dci[k]), as the plain
+    // escape time loop counts them (a MandelbrotCalculator::PointKernel)
+    void iterate(const double *dcr, const double *dci, IterationCount *out, int count, int maxIter) const;
+
+    int getLength() const { return static_cast<int>(zr.size()); }
+    int getSkip() const { return skip; }                    // Iterations the series skips
+    double getMilliseconds() const { return milliseconds; } // Of the last computation
+
+private:
+    BigFloat cre, cim;
+    int precision = 0;
+    int maxIter = 0;
+    double milliseconds = 0.0;
+
+    // Z(0) = 0, Z(1) = c... rounded to doubles, up to the first escaped value
+    std::vector<double> zr, zi;
+
+    // d(skip) = sum of series[k] * (dc / seriesRadius)^(k + 1): coefficients
+    // scaled by the radius stay in range where dc^k would underflow
+    static constexpr int SERIES_TERMS = 16;
+    double seriesR[SERIES_TERMS], seriesI[SERIES_TERMS];
+    double seriesRadius = 0.0;
+    double seriesHalfWidth = -1.0, seriesHalfHeight = -1.0; // View of the coefficients
+    int skip = 0;
+};
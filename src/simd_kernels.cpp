@@ -0,0 +1,890 @@
+#include "simd_kernels.h"
+#include "interior_check.h"
+#include <algorithm>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SIMD_KERNELS_X86 1
+#include <immintrin.h>
+#else
+#define SIMD_KERNELS_X86 0
+#endif
+
+// Every kernel runs the same recurrence as the scalar engines:
+//   r2 = r*r, i2 = i*i; stop if r2 + i2 >= 4; i = 2ri + y; r = r2 - i2 + x
+// with separate multiplies and adds, so all engines agree pixel for pixel.
+// Lanes keep updating z after they escape (cheaper than blending); their
+// iteration count is frozen by the sticky active mask.
+//
+// The CHECK variants implement SimdKernels' interiorCheck: cardioid/bulb
+// points are answered when a lane is loaded, and each lane compares z with
+// a copy saved every PERIOD_WINDOW steps (any period up to the window is
+// caught). Only exact repeats count, so the results do not change.
+
+static constexpr int PERIOD_WINDOW = 32;
+
+// Saved z of a lane that has not reached a save point yet: never equal
+static const double NO_SAVE = std::numeric_limits<double>::quiet_NaN();
+
+// Portable version: the original branchless 8-lane loop, vectorized by the
+// compiler for whatever target the build uses (e.g. NEON on ARM)
+template <bool CHECK>
+static void kernelGeneric(const double *cr, const double *ci, IterationCount *out, int count, int maxIter)
+{
+    constexpr int LANES = 8;
+
+    for (int base = 0; base < count; base += LANES)
+    {
+        int n = std::min(LANES, count - base);
+
+        // Use 64-bit integers for mask and iters to match double width (helps vectorization)
+        alignas(64) double x[LANES];
+        alignas(64) double y[LANES];
+        alignas(64) double zr[LANES];
+        alignas(64) double zi[LANES];
+        alignas(64) long long iters[LANES];
+        alignas(64) long long mask[LANES]; // 1 if active, 0 if escaped
+        alignas(64) double sr[LANES];
+        alignas(64) double si[LANES];
+        alignas(64) long long interior[LANES]; // 1 if known not to escape
+
+        // Padding lanes duplicate the first point and start inactive
+        for (int l = 0; l < LANES; ++l)
+        {
+            int src = base + (l < n ? l : 0);
+            x[l] = zr[l] = cr[src];
+            y[l] = zi[l] = ci[src];
+            iters[l] = 0;
+            interior[l] = CHECK && l < n && inMainCardioidOrBulb(x[l], y[l]);
+            mask[l] = (l < n && !interior[l]) ? 1 : 0;
+            sr[l] = si[l] = NO_SAVE;
+        }
+
+        for (int k = 0; k < maxIter; ++k)
+        {
+            if constexpr (CHECK)
+            {
+                for (int l = 0; l < LANES; ++l)
+                {
+                    long long same = (zr[l] == sr[l]) & (zi[l] == si[l]);
+                    interior[l] |= mask[l] & same;
+                    mask[l] &= same ^ 1;
+                }
+                if (k % PERIOD_WINDOW == 0)
+                {
+                    for (int l = 0; l < LANES; ++l)
+                    {
+                        sr[l] = zr[l];
+                        si[l] = zi[l];
+                    }
+                }
+            }
+
+            long long active = 0;
+            for (int l = 0; l < LANES; ++l)
+            {
+                double r2 = zr[l] * zr[l];
+                double i2 = zi[l] * zi[l];
+                double ri = zr[l] * zi[l];
+
+                mask[l] &= (r2 + i2 < 4.0);
+                active |= mask[l];
+                iters[l] += mask[l];
+
+                zi[l] = ri + ri + y[l];
+                zr[l] = r2 - i2 + x[l];
+            }
+
+            if (active == 0)
+                break;
+        }
+
+        for (int l = 0; l < n; ++l)
+        {
+            out[base + l] = interior[l] ? maxIter : static_cast<int>(iters[l]);
+        }
+    }
+}
+
+// Refill kernels: a lane whose point escaped (or hit maxIter) stores its
+// result and immediately takes the next pending point, so no lane idles
+// while the slowest point of a batch finishes. Only when the pending list
+// runs out do lanes go idle. Lane state is spilled to memory only on the
+// (comparatively rare) iterations where some lane finishes. A finished lane
+// that did not escape (maxIter, or a repeat) is stored as maxIter.
+
+template <bool CHECK>
+static void kernelGenericRefill(const double *cr, const double *ci, IterationCount *out, int count, int maxIter)
+{
+    constexpr int LANES = 8;
+
+    alignas(64) double x[LANES];
+    alignas(64) double y[LANES];
+    alignas(64) double zr[LANES];
+    alignas(64) double zi[LANES];
+    alignas(64) long long iters[LANES];
+    alignas(64) long long finished[LANES];
+    alignas(64) double sr[LANES];
+    alignas(64) double si[LANES];
+    int index[LANES]; // Point held by each lane, -1 when idle
+
+    int next = 0;
+    int activeLanes = 0;
+    auto loadLane = [&](int l)
+    {
+        if constexpr (CHECK)
+        {
+            while (next < count && inMainCardioidOrBulb(cr[next], ci[next]))
+                out[next++] = maxIter;
+        }
+
+        if (next < count)
+        {
+            index[l] = next;
+            x[l] = zr[l] = cr[next];
+            y[l] = zi[l] = ci[next];
+            ++next;
+            ++activeLanes;
+        }
+        else
+        {
+            // Idle lane: z stays at 0 and never escapes
+            index[l] = -1;
+            x[l] = y[l] = zr[l] = zi[l] = 0.0;
+        }
+        iters[l] = 0;
+        sr[l] = si[l] = NO_SAVE;
+    };
+
+    for (int l = 0; l < LANES; ++l)
+        loadLane(l);
+
+    unsigned step = 0;
+    while (activeLanes > 0)
+    {
+        long long anyFinished = 0;
+        for (int l = 0; l < LANES; ++l)
+        {
+            double r2 = zr[l] * zr[l];
+            double i2 = zi[l] * zi[l];
+            long long stop = (r2 + i2 >= 4.0) | (iters[l] == maxIter);
+            if constexpr (CHECK)
+                stop |= (zr[l] == sr[l]) & (zi[l] == si[l]);
+            finished[l] = (index[l] >= 0) & stop;
+            anyFinished |= finished[l];
+        }
+
+        if (anyFinished)
+        {
+            for (int l = 0; l < LANES; ++l)
+            {
+                if (finished[l])
+                {
+                    bool escaped = zr[l] * zr[l] + zi[l] * zi[l] >= 4.0;
+                    out[index[l]] = escaped ? static_cast<int>(iters[l]) : maxIter;
+                    --activeLanes;
+                    loadLane(l);
+                }
+            }
+            continue;
+        }
+
+        if constexpr (CHECK)
+        {
+            if (step++ % PERIOD_WINDOW == 0)
+            {
+                for (int l = 0; l < LANES; ++l)
+                {
+                    sr[l] = zr[l];
+                    si[l] = zi[l];
+                }
+            }
+        }
+
+        for (int l = 0; l < LANES; ++l)
+        {
+            double r2 = zr[l] * zr[l];
+            double i2 = zi[l] * zi[l];
+            double ri = zr[l] * zi[l];
+            zi[l] = ri + ri + y[l];
+            zr[l] = r2 - i2 + x[l];
+            iters[l] += 1;
+        }
+    }
+}
+
+#if SIMD_KERNELS_X86
+
+// SSE2: 4 vectors of 2 doubles = 8 lanes per batch
+template <bool CHECK>
+__attribute__((target("sse2"))) static void kernelSse2(const double *cr, const double *ci, IterationCount *out, int count, int maxIter)
+{
+    constexpr int LANES = 8;
+    constexpr int VECS = LANES / 2;
+    const __m128d four = _mm_set1_pd(4.0);
+
+    for (int base = 0; base < count; base += LANES)
+    {
+        int n = std::min(LANES, count - base);
+
+        alignas(16) double xs[LANES];
+        alignas(16) double ys[LANES];
+        alignas(16) long long initMask[LANES];
+        alignas(16) long long interior[LANES];
+        for (int l = 0; l < LANES; ++l)
+        {
+            int src = base + (l < n ? l : 0);
+            xs[l] = cr[src];
+            ys[l] = ci[src];
+            interior[l] = (CHECK && l < n && inMainCardioidOrBulb(xs[l], ys[l])) ? -1 : 0;
+            initMask[l] = (l < n && !interior[l]) ? -1 : 0;
+        }
+
+        __m128d x[VECS], y[VECS], r[VECS], i[VECS], m[VECS];
+        __m128d sr[VECS], si[VECS], cycled[VECS];
+        __m128i iters[VECS];
+        for (int v = 0; v < VECS; ++v)
+        {
+            x[v] = r[v] = _mm_load_pd(xs + 2 * v);
+            y[v] = i[v] = _mm_load_pd(ys + 2 * v);
+            m[v] = _mm_castsi128_pd(_mm_load_si128(reinterpret_cast<const __m128i *>(initMask + 2 * v)));
+            iters[v] = _mm_setzero_si128();
+            sr[v] = si[v] = _mm_set1_pd(NO_SAVE);
+            cycled[v] = _mm_castsi128_pd(_mm_load_si128(reinterpret_cast<const __m128i *>(interior + 2 * v)));
+        }
+
+        for (int k = 0; k < maxIter; ++k)
+        {
+            if constexpr (CHECK)
+            {
+                for (int v = 0; v < VECS; ++v)
+                {
+                    __m128d same = _mm_and_pd(_mm_cmpeq_pd(r[v], sr[v]), _mm_cmpeq_pd(i[v], si[v]));
+                    cycled[v] = _mm_or_pd(cycled[v], _mm_and_pd(m[v], same));
+                    m[v] = _mm_andnot_pd(same, m[v]);
+                }
+                if (k % PERIOD_WINDOW == 0)
+                {
+                    for (int v = 0; v < VECS; ++v)
+                    {
+                        sr[v] = r[v];
+                        si[v] = i[v];
+                    }
+                }
+            }
+
+            __m128d r2[VECS], i2[VECS];
+            int active = 0;
+            for (int v = 0; v < VECS; ++v)
+            {
+                r2[v] = _mm_mul_pd(r[v], r[v]);
+                i2[v] = _mm_mul_pd(i[v], i[v]);
+                m[v] = _mm_and_pd(m[v], _mm_cmplt_pd(_mm_add_pd(r2[v], i2[v]), four));
+                active |= _mm_movemask_pd(m[v]);
+            }
+
+            if (active == 0)
+                break;
+
+            for (int v = 0; v < VECS; ++v)
+            {
+                // Active lanes are all ones (-1): subtracting counts them
+                iters[v] = _mm_sub_epi64(iters[v], _mm_castpd_si128(m[v]));
+
+                __m128d ri = _mm_mul_pd(r[v], i[v]);
+                i[v] = _mm_add_pd(_mm_add_pd(ri, ri), y[v]);
+                r[v] = _mm_add_pd(_mm_sub_pd(r2[v], i2[v]), x[v]);
+            }
+        }
+
+        alignas(16) long long result[LANES];
+        for (int v = 0; v < VECS; ++v)
+        {
+            _mm_store_si128(reinterpret_cast<__m128i *>(result + 2 * v), iters[v]);
+            _mm_store_si128(reinterpret_cast<__m128i *>(interior + 2 * v), _mm_castpd_si128(cycled[v]));
+        }
+        for (int l = 0; l < n; ++l)
+        {
+            out[base + l] = interior[l] ? maxIter : static_cast<int>(result[l]);
+        }
+    }
+}
+
+// AVX2: 2 vectors of 4 doubles = 8 lanes per batch (two independent
+// dependency chains keep the multiplier busy)
+template <bool CHECK>
+__attribute__((target("avx2"))) static void kernelAvx2(const double *cr, const double *ci, IterationCount *out, int count, int maxIter)
+{
+    constexpr int LANES = 8;
+    const __m256d four = _mm256_set1_pd(4.0);
+
+    for (int base = 0; base < count; base += LANES)
+    {
+        int n = std::min(LANES, count - base);
+
+        alignas(32) double xs[LANES];
+        alignas(32) double ys[LANES];
+        alignas(32) long long initMask[LANES];
+        alignas(32) long long interior[LANES];
+        for (int l = 0; l < LANES; ++l)
+        {
+            int src = base + (l < n ? l : 0);
+            xs[l] = cr[src];
+            ys[l] = ci[src];
+            interior[l] = (CHECK && l < n && inMainCardioidOrBulb(xs[l], ys[l])) ? -1 : 0;
+            initMask[l] = (l < n && !interior[l]) ? -1 : 0;
+        }
+
+        __m256d x0 = _mm256_load_pd(xs), x1 = _mm256_load_pd(xs + 4);
+        __m256d y0 = _mm256_load_pd(ys), y1 = _mm256_load_pd(ys + 4);
+        __m256d r0 = x0, r1 = x1, i0 = y0, i1 = y1;
+        __m256d m0 = _mm256_castsi256_pd(_mm256_load_si256(reinterpret_cast<const __m256i *>(initMask)));
+        __m256d m1 = _mm256_castsi256_pd(_mm256_load_si256(reinterpret_cast<const __m256i *>(initMask + 4)));
+        __m256i iters0 = _mm256_setzero_si256(), iters1 = _mm256_setzero_si256();
+        __m256d sr0 = _mm256_set1_pd(NO_SAVE), sr1 = sr0, si0 = sr0, si1 = sr0;
+        __m256d cycled0 = _mm256_castsi256_pd(_mm256_load_si256(reinterpret_cast<const __m256i *>(interior)));
+        __m256d cycled1 = _mm256_castsi256_pd(_mm256_load_si256(reinterpret_cast<const __m256i *>(interior + 4)));
+
+        for (int k = 0; k < maxIter; ++k)
+        {
+            if constexpr (CHECK)
+            {
+                __m256d same0 = _mm256_and_pd(_mm256_cmp_pd(r0, sr0, _CMP_EQ_OQ), _mm256_cmp_pd(i0, si0, _CMP_EQ_OQ));
+                __m256d same1 = _mm256_and_pd(_mm256_cmp_pd(r1, sr1, _CMP_EQ_OQ), _mm256_cmp_pd(i1, si1, _CMP_EQ_OQ));
+                cycled0 = _mm256_or_pd(cycled0, _mm256_and_pd(m0, same0));
+                cycled1 = _mm256_or_pd(cycled1, _mm256_and_pd(m1, same1));
+                m0 = _mm256_andnot_pd(same0, m0);
+                m1 = _mm256_andnot_pd(same1, m1);
+                if (k % PERIOD_WINDOW == 0)
+                {
+                    sr0 = r0, sr1 = r1;
+                    si0 = i0, si1 = i1;
+                }
+            }
+
+            __m256d r2_0 = _mm256_mul_pd(r0, r0), r2_1 = _mm256_mul_pd(r1, r1);
+            __m256d i2_0 = _mm256_mul_pd(i0, i0), i2_1 = _mm256_mul_pd(i1, i1);
+
+            m0 = _mm256_and_pd(m0, _mm256_cmp_pd(_mm256_add_pd(r2_0, i2_0), four, _CMP_LT_OQ));
+            m1 = _mm256_and_pd(m1, _mm256_cmp_pd(_mm256_add_pd(r2_1, i2_1), four, _CMP_LT_OQ));
+
+            if ((_mm256_movemask_pd(m0) | _mm256_movemask_pd(m1)) == 0)
+                break;
+
+            iters0 = _mm256_sub_epi64(iters0, _mm256_castpd_si256(m0));
+            iters1 = _mm256_sub_epi64(iters1, _mm256_castpd_si256(m1));
+
+            __m256d ri0 = _mm256_mul_pd(r0, i0), ri1 = _mm256_mul_pd(r1, i1);
+            i0 = _mm256_add_pd(_mm256_add_pd(ri0, ri0), y0);
+            i1 = _mm256_add_pd(_mm256_add_pd(ri1, ri1), y1);
+            r0 = _mm256_add_pd(_mm256_sub_pd(r2_0, i2_0), x0);
+            r1 = _mm256_add_pd(_mm256_sub_pd(r2_1, i2_1), x1);
+        }
+
+        alignas(32) long long result[LANES];
+        _mm256_store_si256(reinterpret_cast<__m256i *>(result), iters0);
+        _mm256_store_si256(reinterpret_cast<__m256i *>(result + 4), iters1);
+        _mm256_store_si256(reinterpret_cast<__m256i *>(interior), _mm256_castpd_si256(cycled0));
+        _mm256_store_si256(reinterpret_cast<__m256i *>(interior + 4), _mm256_castpd_si256(cycled1));
+        for (int l = 0; l < n; ++l)
+        {
+            out[base + l] = interior[l] ? maxIter : static_cast<int>(result[l]);
+        }
+    }
+}
+
+// AVX-512: 2 vectors of 8 doubles = 16 lanes per batch, active lanes in mask registers
+template <bool CHECK>
+__attribute__((target("avx512f"))) static void kernelAvx512(const double *cr, const double *ci, IterationCount *out, int count, int maxIter)
+{
+    constexpr int LANES = 16;
+    const __m512d four = _mm512_set1_pd(4.0);
+    const __m512i one = _mm512_set1_epi64(1);
+
+    for (int base = 0; base < count; base += LANES)
+    {
+        int n = std::min(LANES, count - base);
+
+        alignas(64) double xs[LANES];
+        alignas(64) double ys[LANES];
+        unsigned live = 0, interior = 0;
+        for (int l = 0; l < LANES; ++l)
+        {
+            int src = base + (l < n ? l : 0);
+            xs[l] = cr[src];
+            ys[l] = ci[src];
+            if (l < n)
+            {
+                if (CHECK && inMainCardioidOrBulb(xs[l], ys[l]))
+                    interior |= 1u << l;
+                else
+                    live |= 1u << l;
+            }
+        }
+
+        __m512d x0 = _mm512_load_pd(xs), x1 = _mm512_load_pd(xs + 8);
+        __m512d y0 = _mm512_load_pd(ys), y1 = _mm512_load_pd(ys + 8);
+        __m512d r0 = x0, r1 = x1, i0 = y0, i1 = y1;
+        __mmask8 m0 = static_cast<__mmask8>(live), m1 = static_cast<__mmask8>(live >> 8);
+        __m512i iters0 = _mm512_setzero_si512(), iters1 = _mm512_setzero_si512();
+        __m512d sr0 = _mm512_set1_pd(NO_SAVE), sr1 = sr0, si0 = sr0, si1 = sr0;
+
+        for (int k = 0; k < maxIter; ++k)
+        {
+            if constexpr (CHECK)
+            {
+                __mmask8 same0 = _mm512_mask_cmp_pd_mask(m0, r0, sr0, _CMP_EQ_OQ) & _mm512_cmp_pd_mask(i0, si0, _CMP_EQ_OQ);
+                __mmask8 same1 = _mm512_mask_cmp_pd_mask(m1, r1, sr1, _CMP_EQ_OQ) & _mm512_cmp_pd_mask(i1, si1, _CMP_EQ_OQ);
+                interior |= same0 | (static_cast<unsigned>(same1) << 8);
+                m0 &= ~same0;
+                m1 &= ~same1;
+                if (k % PERIOD_WINDOW == 0)
+                {
+                    sr0 = r0, sr1 = r1;
+                    si0 = i0, si1 = i1;
+                }
+            }
+
+            __m512d r2_0 = _mm512_mul_pd(r0, r0), r2_1 = _mm512_mul_pd(r1, r1);
+            __m512d i2_0 = _mm512_mul_pd(i0, i0), i2_1 = _mm512_mul_pd(i1, i1);
+
+            m0 = _mm512_mask_cmp_pd_mask(m0, _mm512_add_pd(r2_0, i2_0), four, _CMP_LT_OQ);
+            m1 = _mm512_mask_cmp_pd_mask(m1, _mm512_add_pd(r2_1, i2_1), four, _CMP_LT_OQ);
+
+            if ((m0 | m1) == 0)
+                break;
+
+            iters0 = _mm512_mask_add_epi64(iters0, m0, iters0, one);
+            iters1 = _mm512_mask_add_epi64(iters1, m1, iters1, one);
+
+            __m512d ri0 = _mm512_mul_pd(r0, i0), ri1 = _mm512_mul_pd(r1, i1);
+            i0 = _mm512_add_pd(_mm512_add_pd(ri0, ri0), y0);
+            i1 = _mm512_add_pd(_mm512_add_pd(ri1, ri1), y1);
+            r0 = _mm512_add_pd(_mm512_sub_pd(r2_0, i2_0), x0);
+            r1 = _mm512_add_pd(_mm512_sub_pd(r2_1, i2_1), x1);
+        }
+
+        alignas(64) long long result[LANES];
+        _mm512_store_si512(result, iters0);
+        _mm512_store_si512(result + 8, iters1);
+        for (int l = 0; l < n; ++l)
+        {
+            out[base + l] = (interior & (1u << l)) ? maxIter : static_cast<int>(result[l]);
+        }
+    }
+}
+
+// Lane state of the x86 refill kernels while it is spilled to memory
+template <int LANES, bool CHECK>
+struct RefillLanes
+{
+    alignas(64) double x[LANES];
+    alignas(64) double y[LANES];
+    alignas(64) double r[LANES];
+    alignas(64) double i[LANES];
+    alignas(64) double iters[LANES];   // Counted in doubles (exact, and SSE2/AVX2 compare them natively)
+    alignas(64) long long idle[LANES]; // All ones when the lane holds no point
+    alignas(64) double sr[LANES];      // Saved z (CHECK only)
+    alignas(64) double si[LANES];
+    int index[LANES];
+
+    const double *cr;
+    const double *ci;
+    IterationCount *out;
+    int count;
+    int maxIter;
+    int next;
+    int activeLanes;
+
+    RefillLanes(const double *cr_, const double *ci_, IterationCount *out_, int count_, int maxIter_)
+        : cr(cr_), ci(ci_), out(out_), count(count_), maxIter(maxIter_), next(0), activeLanes(0)
+    {
+        for (int l = 0; l < LANES; ++l)
+            load(l);
+    }
+
+    void load(int l)
+    {
+        if constexpr (CHECK)
+        {
+            while (next < count && inMainCardioidOrBulb(cr[next], ci[next]))
+                out[next++] = maxIter;
+        }
+
+        if (next < count)
+        {
+            index[l] = next;
+            x[l] = r[l] = cr[next];
+            y[l] = i[l] = ci[next];
+            idle[l] = 0;
+            ++next;
+            ++activeLanes;
+        }
+        else
+        {
+            // Idle lane: z stays at 0 and never escapes
+            index[l] = -1;
+            x[l] = y[l] = r[l] = i[l] = 0.0;
+            idle[l] = -1;
+        }
+        iters[l] = 0.0;
+        sr[l] = si[l] = NO_SAVE;
+    }
+
+    // Store the result of every lane flagged in finishedBits and refill it
+    void retire(unsigned finishedBits)
+    {
+        for (int l = 0; l < LANES; ++l)
+        {
+            if (finishedBits & (1u << l))
+            {
+                bool escaped = r[l] * r[l] + i[l] * i[l] >= 4.0;
+                out[index[l]] = escaped ? static_cast<int>(iters[l]) : maxIter;
+                --activeLanes;
+                load(l);
+            }
+        }
+    }
+};
+
+template <bool CHECK>
+__attribute__((target("sse2"))) static void kernelSse2Refill(const double *cr, const double *ci, IterationCount *out, int count, int maxIter)
+{
+    constexpr int LANES = 8;
+    constexpr int VECS = LANES / 2;
+    const __m128d four = _mm_set1_pd(4.0);
+    const __m128d one = _mm_set1_pd(1.0);
+    const __m128d maxv = _mm_set1_pd(maxIter);
+
+    RefillLanes<LANES, CHECK> lanes(cr, ci, out, count, maxIter);
+    __m128d x[VECS], y[VECS], r[VECS], i[VECS], iters[VECS], idle[VECS], sr[VECS], si[VECS];
+    unsigned step = 0;
+
+    // Outer loop: (re)load the lanes into registers after a refill.
+    // Inner loop: iterate until some lane finishes.
+    while (lanes.activeLanes > 0)
+    {
+        for (int v = 0; v < VECS; ++v)
+        {
+            x[v] = _mm_load_pd(lanes.x + 2 * v);
+            y[v] = _mm_load_pd(lanes.y + 2 * v);
+            r[v] = _mm_load_pd(lanes.r + 2 * v);
+            i[v] = _mm_load_pd(lanes.i + 2 * v);
+            iters[v] = _mm_load_pd(lanes.iters + 2 * v);
+            idle[v] = _mm_castsi128_pd(_mm_load_si128(reinterpret_cast<const __m128i *>(lanes.idle + 2 * v)));
+            if constexpr (CHECK)
+            {
+                sr[v] = _mm_load_pd(lanes.sr + 2 * v);
+                si[v] = _mm_load_pd(lanes.si + 2 * v);
+            }
+        }
+
+        for (;;)
+        {
+            __m128d r2[VECS], i2[VECS];
+            unsigned finishedBits = 0;
+            for (int v = 0; v < VECS; ++v)
+            {
+                r2[v] = _mm_mul_pd(r[v], r[v]);
+                i2[v] = _mm_mul_pd(i[v], i[v]);
+                __m128d finished = _mm_or_pd(_mm_cmpge_pd(_mm_add_pd(r2[v], i2[v]), four), _mm_cmpeq_pd(iters[v], maxv));
+                if constexpr (CHECK)
+                    finished = _mm_or_pd(finished, _mm_and_pd(_mm_cmpeq_pd(r[v], sr[v]), _mm_cmpeq_pd(i[v], si[v])));
+                finishedBits |= static_cast<unsigned>(_mm_movemask_pd(_mm_andnot_pd(idle[v], finished))) << (2 * v);
+            }
+
+            if (finishedBits)
+            {
+                for (int v = 0; v < VECS; ++v)
+                {
+                    _mm_store_pd(lanes.r + 2 * v, r[v]);
+                    _mm_store_pd(lanes.i + 2 * v, i[v]);
+                    _mm_store_pd(lanes.iters + 2 * v, iters[v]);
+                    if constexpr (CHECK)
+                    {
+                        _mm_store_pd(lanes.sr + 2 * v, sr[v]);
+                        _mm_store_pd(lanes.si + 2 * v, si[v]);
+                    }
+                }
+                lanes.retire(finishedBits);
+                break;
+            }
+
+            if constexpr (CHECK)
+            {
+                if (step++ % PERIOD_WINDOW == 0)
+                {
+                    for (int v = 0; v < VECS; ++v)
+                    {
+                        sr[v] = r[v];
+                        si[v] = i[v];
+                    }
+                }
+            }
+
+            for (int v = 0; v < VECS; ++v)
+            {
+                __m128d ri = _mm_mul_pd(r[v], i[v]);
+                i[v] = _mm_add_pd(_mm_add_pd(ri, ri), y[v]);
+                r[v] = _mm_add_pd(_mm_sub_pd(r2[v], i2[v]), x[v]);
+                iters[v] = _mm_add_pd(iters[v], one);
+            }
+        }
+    }
+}
+
+template <bool CHECK>
+__attribute__((target("avx2"))) static void kernelAvx2Refill(const double *cr, const double *ci, IterationCount *out, int count, int maxIter)
+{
+    constexpr int LANES = 8;
+    constexpr int VECS = LANES / 4;
+    const __m256d four = _mm256_set1_pd(4.0);
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d maxv = _mm256_set1_pd(maxIter);
+
+    RefillLanes<LANES, CHECK> lanes(cr, ci, out, count, maxIter);
+    __m256d x[VECS], y[VECS], r[VECS], i[VECS], iters[VECS], idle[VECS], sr[VECS], si[VECS];
+    unsigned step = 0;
+
+    // Outer loop: (re)load the lanes into registers after a refill.
+    // Inner loop: iterate until some lane finishes.
+    while (lanes.activeLanes > 0)
+    {
+        for (int v = 0; v < VECS; ++v)
+        {
+            x[v] = _mm256_load_pd(lanes.x + 4 * v);
+            y[v] = _mm256_load_pd(lanes.y + 4 * v);
+            r[v] = _mm256_load_pd(lanes.r + 4 * v);
+            i[v] = _mm256_load_pd(lanes.i + 4 * v);
+            iters[v] = _mm256_load_pd(lanes.iters + 4 * v);
+            idle[v] = _mm256_castsi256_pd(_mm256_load_si256(reinterpret_cast<const __m256i *>(lanes.idle + 4 * v)));
+            if constexpr (CHECK)
+            {
+                sr[v] = _mm256_load_pd(lanes.sr + 4 * v);
+                si[v] = _mm256_load_pd(lanes.si + 4 * v);
+            }
+        }
+
+        for (;;)
+        {
+            __m256d r2[VECS], i2[VECS];
+            unsigned finishedBits = 0;
+            for (int v = 0; v < VECS; ++v)
+            {
+                r2[v] = _mm256_mul_pd(r[v], r[v]);
+                i2[v] = _mm256_mul_pd(i[v], i[v]);
+                __m256d finished = _mm256_or_pd(_mm256_cmp_pd(_mm256_add_pd(r2[v], i2[v]), four, _CMP_GE_OQ),
+                                                _mm256_cmp_pd(iters[v], maxv, _CMP_EQ_OQ));
+                if constexpr (CHECK)
+                    finished = _mm256_or_pd(finished, _mm256_and_pd(_mm256_cmp_pd(r[v], sr[v], _CMP_EQ_OQ),
+                                                                    _mm256_cmp_pd(i[v], si[v], _CMP_EQ_OQ)));
+                finishedBits |= static_cast<unsigned>(_mm256_movemask_pd(_mm256_andnot_pd(idle[v], finished))) << (4 * v);
+            }
+
+            if (finishedBits)
+            {
+                for (int v = 0; v < VECS; ++v)
+                {
+                    _mm256_store_pd(lanes.r + 4 * v, r[v]);
+                    _mm256_store_pd(lanes.i + 4 * v, i[v]);
+                    _mm256_store_pd(lanes.iters + 4 * v, iters[v]);
+                    if constexpr (CHECK)
+                    {
+                        _mm256_store_pd(lanes.sr + 4 * v, sr[v]);
+                        _mm256_store_pd(lanes.si + 4 * v, si[v]);
+                    }
+                }
+                lanes.retire(finishedBits);
+                break;
+            }
+
+            if constexpr (CHECK)
+            {
+                if (step++ % PERIOD_WINDOW == 0)
+                {
+                    for (int v = 0; v < VECS; ++v)
+                    {
+                        sr[v] = r[v];
+                        si[v] = i[v];
+                    }
+                }
+            }
+
+            for (int v = 0; v < VECS; ++v)
+            {
+                __m256d ri = _mm256_mul_pd(r[v], i[v]);
+                i[v] = _mm256_add_pd(_mm256_add_pd(ri, ri), y[v]);
+                r[v] = _mm256_add_pd(_mm256_sub_pd(r2[v], i2[v]), x[v]);
+                iters[v] = _mm256_add_pd(iters[v], one);
+            }
+        }
+    }
+}
+
+template <bool CHECK>
+__attribute__((target("avx512f"))) static void kernelAvx512Refill(const double *cr, const double *ci, IterationCount *out, int count, int maxIter)
+{
+    constexpr int LANES = 16;
+    constexpr int VECS = LANES / 8;
+    const __m512d four = _mm512_set1_pd(4.0);
+    const __m512d one = _mm512_set1_pd(1.0);
+    const __m512d maxv = _mm512_set1_pd(maxIter);
+
+    RefillLanes<LANES, CHECK> lanes(cr, ci, out, count, maxIter);
+    __m512d x[VECS], y[VECS], r[VECS], i[VECS], iters[VECS], sr[VECS], si[VECS];
+    __mmask8 busy[VECS]; // Lanes holding a point
+    unsigned step = 0;
+
+    // Outer loop: (re)load the lanes into registers after a refill.
+    // Inner loop: iterate until some lane finishes.
+    while (lanes.activeLanes > 0)
+    {
+        for (int v = 0; v < VECS; ++v)
+        {
+            x[v] = _mm512_load_pd(lanes.x + 8 * v);
+            y[v] = _mm512_load_pd(lanes.y + 8 * v);
+            r[v] = _mm512_load_pd(lanes.r + 8 * v);
+            i[v] = _mm512_load_pd(lanes.i + 8 * v);
+            iters[v] = _mm512_load_pd(lanes.iters + 8 * v);
+            busy[v] = _mm512_cmpeq_epi64_mask(_mm512_load_si512(lanes.idle + 8 * v), _mm512_setzero_si512());
+            if constexpr (CHECK)
+            {
+                sr[v] = _mm512_load_pd(lanes.sr + 8 * v);
+                si[v] = _mm512_load_pd(lanes.si + 8 * v);
+            }
+        }
+
+        for (;;)
+        {
+            __m512d r2[VECS], i2[VECS];
+            unsigned finishedBits = 0;
+            for (int v = 0; v < VECS; ++v)
+            {
+                r2[v] = _mm512_mul_pd(r[v], r[v]);
+                i2[v] = _mm512_mul_pd(i[v], i[v]);
+                __mmask8 finished = _mm512_mask_cmp_pd_mask(busy[v], _mm512_add_pd(r2[v], i2[v]), four, _CMP_GE_OQ) |
+                                    _mm512_mask_cmp_pd_mask(busy[v], iters[v], maxv, _CMP_EQ_OQ);
+                if constexpr (CHECK)
+                    finished |= _mm512_mask_cmp_pd_mask(busy[v], r[v], sr[v], _CMP_EQ_OQ) &
+                                _mm512_cmp_pd_mask(i[v], si[v], _CMP_EQ_OQ);
+                finishedBits |= static_cast<unsigned>(finished) << (8 * v);
+            }
+
+            if (finishedBits)
+            {
+                for (int v = 0; v < VECS; ++v)
+                {
+                    _mm512_store_pd(lanes.r + 8 * v, r[v]);
+                    _mm512_store_pd(lanes.i + 8 * v, i[v]);
+                    _mm512_store_pd(lanes.iters + 8 * v, iters[v]);
+                    if constexpr (CHECK)
+                    {
+                        _mm512_store_pd(lanes.sr + 8 * v, sr[v]);
+                        _mm512_store_pd(lanes.si + 8 * v, si[v]);
+                    }
+                }
+                lanes.retire(finishedBits);
+                break;
+            }
+
+            if constexpr (CHECK)
+            {
+                if (step++ % PERIOD_WINDOW == 0)
+                {
+                    for (int v = 0; v < VECS; ++v)
+                    {
+                        sr[v] = r[v];
+                        si[v] = i[v];
+                    }
+                }
+            }
+
+            for (int v = 0; v < VECS; ++v)
+            {
+                __m512d ri = _mm512_mul_pd(r[v], i[v]);
+                i[v] = _mm512_add_pd(_mm512_add_pd(ri, ri), y[v]);
+                r[v] = _mm512_add_pd(_mm512_sub_pd(r2[v], i2[v]), x[v]);
+                iters[v] = _mm512_add_pd(iters[v], one);
+            }
+        }
+    }
+}
+
+#endif // SIMD_KERNELS_X86
+
+bool SimdKernels::isSupported(Level level)
+{
+#if SIMD_KERNELS_X86
+    __builtin_cpu_init();
+    switch (level)
+    {
+    case Level::GENERIC:
+        return true;
+    case Level::SSE2:
+        return __builtin_cpu_supports("sse2");
+    case Level::AVX2:
+        return __builtin_cpu_supports("avx2");
+    case Level::AVX512:
+        return __builtin_cpu_supports("avx512f");
+    }
+    return false;
+#else
+    return level == Level::GENERIC;
+#endif
+}
+
+SimdKernels::Level SimdKernels::bestLevel()
+{
+    static const Level best = []()
+    {
+        for (Level level : {Level::AVX512, Level::AVX2, Level::SSE2})
+        {
+            if (isSupported(level))
+                return level;
+        }
+        return Level::GENERIC;
+    }();
+    return best;
+}
+
+template <bool CHECK>
+static SimdKernels::Kernel selectKernel(SimdKernels::Level level, bool refill)
+{
+    switch (level)
+    {
+#if SIMD_KERNELS_X86
+    case SimdKernels::Level::SSE2:
+        return refill ? kernelSse2Refill<CHECK> : kernelSse2<CHECK>;
+    case SimdKernels::Level::AVX2:
+        return refill ? kernelAvx2Refill<CHECK> : kernelAvx2<CHECK>;
+    case SimdKernels::Level::AVX512:
+        return refill ? kernelAvx512Refill<CHECK> : kernelAvx512<CHECK>;
+#endif
+    default:
+        return refill ? kernelGenericRefill<CHECK> : kernelGeneric<CHECK>;
+    }
+}
+
+SimdKernels::Kernel SimdKernels::get(Level level, Mode mode, bool interiorCheck)
+{
+    if (!isSupported(level))
+        level = Level::GENERIC;
+
+    bool refill = mode == Mode::REFILL;
+    return interiorCheck ? selectKernel<true>(level, refill) : selectKernel<false>(level, refill);
+}
+
+const char *SimdKernels::getLevelName(Level level)
+{
+    switch (level)
+    {
+    case Level::SSE2:
+        return "sse2";
+    case Level::AVX2:
+        return "avx2";
+    case Level::AVX512:
+        return "avx512";
+    default:
+        return "generic";
+    }
+}
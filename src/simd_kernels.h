@@ -0,0 +1,42 @@
+#pragma once
+
+#include "mandelbrot_calculator.h"
+
+// Batch escape-time kernels shared by the vectorized engines.
+// Several instruction set versions are compiled into the same binary and the
+// best one supported by the running CPU is selected at startup, so a build
+// made on one host runs (at full speed) on any other.
+class SimdKernels
+{
+public:
+    enum class Level
+    {
+        GENERIC, // Portable branchless loop, left to the auto-vectorizer
+        SSE2,
+        AVX2,
+        AVX512
+    };
+
+    enum class Mode
+    {
+        BATCH,  // Fixed batches: a batch runs until its slowest lane is done
+        REFILL  // A finished lane is reloaded with the next pending point at once
+    };
+
+    // Iterate the points c = (cr[i], ci[i]) for i in [0, count).
+    // out[i] receives the iteration at which the point escaped, or maxIter.
+    // Results are bit-identical to the scalar engines (no FMA contraction).
+    using Kernel = void (*)(const double *cr, const double *ci, IterationCount *out, int count, int maxIter);
+
+    // Best level supported by this CPU (detected once)
+    static Level bestLevel();
+    static bool isSupported(Level level);
+
+    // interiorCheck: points in the main cardioid or period-2 bulb, and points
+    // whose orbit repeats exactly, get maxIter without running to maxIter.
+    // The output is the same as without the checks.
+    static Kernel get(Level level, Mode mode = Mode::BATCH, bool interiorCheck = false);
+    static Kernel best(Mode mode = Mode::BATCH, bool interiorCheck = false) { return get(bestLevel(), mode, interiorCheck); }
+
+    static const char *getLevelName(Level level);
+};
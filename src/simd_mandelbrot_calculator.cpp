@@ -1,113 +1,120 @@
 #include "simd_mandelbrot_calculator.h"
+#include <algorithm>
 #include <cmath>
-#include <array>
+
+// Rows handed to the kernel per call (and between progress updates)
+static constexpr int ROWS_PER_CHUNK = 10;
 
 SimdMandelbrotCalculator::SimdMandelbrotCalculator(int w, int h)
     : StorageMandelbrotCalculator(w, h)
 {
+    setLaneRefill(true);
+    chunkR.resize(width * ROWS_PER_CHUNK);
+    chunkI.resize(width * ROWS_PER_CHUNK);
 }
 
-void SimdMandelbrotCalculator::compute(std::function<void()> progressCallback)
+void SimdMandelbrotCalculator::setLaneRefill(bool enabled)
 {
-    // Batch size for SIMD. 
-    // AVX2 processes 4 doubles (256 bits). AVX-512 processes 8 doubles (512 bits).
-    // 8 is a good number to unroll loops for.
-    constexpr int BATCH_SIZE = 8;
+    laneRefill = enabled;
+    kernel = SimdKernels::best(enabled ? SimdKernels::Mode::REFILL : SimdKernels::Mode::BATCH, interiorCheck);
+}
 
-    unsigned processed = 0;
+void SimdMandelbrotCalculator::setInteriorCheck(bool enabled)
+{
+    StorageMandelbrotCalculator::setInteriorCheck(enabled);
+    setLaneRefill(laneRefill);
+}
 
-    for (int y = 0; y < height; ++y)
+void SimdMandelbrotCalculator::compute(std::function<void()> progressCallback)
+{
+    // The kernel (SSE2/AVX2/AVX-512 or generic) was picked from the CPU
+    // features. It gets several rows per call: with lane refill the lanes
+    // flow from one row to the next instead of draining at each row end.
+    stats.clear();
+    for (int y0 = 0; y0 < height && !isCancelled(); y0 += ROWS_PER_CHUNK)
     {
-        double cy = mini + y * stepi;
-        
-        for (int x = 0; x < width; x += BATCH_SIZE)
-        {
-            int current_batch_size = std::min(BATCH_SIZE, width - x);
-            
-            // Arrays for batch processing
-            // Use 64-bit integers for mask and iters to match double width (helps vectorization)
-            alignas(64) double cr[BATCH_SIZE];
-            alignas(64) double ci[BATCH_SIZE];
-            alignas(64) double zr[BATCH_SIZE];
-            alignas(64) double zi[BATCH_SIZE];
-            alignas(64) long long iters[BATCH_SIZE];
-            alignas(64) long long mask[BATCH_SIZE]; // 1 if active, 0 if escaped
-
-            // Initialize batch
-            // We initialize all BATCH_SIZE elements to ensure the loop size is constant
-            // For elements beyond width, we just duplicate the last valid coordinate or use 0
-            // This avoids branches in initialization
-            for (int i = 0; i < BATCH_SIZE; ++i)
-            {
-                // Use a safe index for calculation to avoid branching
-                // If i >= current_batch_size, we just compute a dummy value (e.g. 0,0)
-                // We won't save it anyway.
-                int offset = (i < current_batch_size) ? i : 0;
-                
-                cr[i] = minr + (x + offset) * stepr;
-                ci[i] = cy;
-                zr[i] = cr[i];
-                zi[i] = ci[i];
-                iters[i] = 0;
-                // Mask is 0 for padding elements so they don't keep iterating
-                mask[i] = (i < current_batch_size) ? 1 : 0;
-            }
+        int rows = std::min(ROWS_PER_CHUNK, height - y0);
 
-            // Main iteration loop
-            for (int k = 0; k < MAX_ITER; ++k)
-            {
-                // Branchless inner loop for better auto-vectorization
-                // The compiler should unroll this and use SIMD instructions
-                for (int i = 0; i < BATCH_SIZE; ++i)
-                {
-                    double r2 = zr[i] * zr[i];
-                    double i2 = zi[i] * zi[i];
-                    double ri = zr[i] * zi[i];
-
-                    // Calculate next values
-                    double next_zr = r2 - i2 + cr[i];
-                    double next_zi = ri + ri + ci[i];
-
-                    // Check escape condition
-                    bool escaped = (r2 + i2 >= 4.0);
-                    
-                    // Update mask: if already inactive (0) or escaped (true), result is 0
-                    mask[i] = mask[i] & (!escaped);
-
-                    // Update Z values only if still active
-                    zr[i] = mask[i] ? next_zr : zr[i];
-                    zi[i] = mask[i] ? next_zi : zi[i];
-                    
-                    // Increment iteration count if active
-                    iters[i] += mask[i];
-                }
-
-                // Check if any lanes are still active
-                // We do this outside the vector loop to avoid breaking vectorization
-                long long active_lanes = 0;
-                for (int i = 0; i < BATCH_SIZE; ++i)
-                {
-                    active_lanes |= mask[i];
-                }
-
-                if (active_lanes == 0)
-                    break;
-            }
+        if (!known.empty())
+        {
+            computeUnknown(y0, rows);
+            if (!speedMode && progressCallback)
+                progressCallback();
+            continue;
+        }
 
-            // Store results
-            for (int i = 0; i < current_batch_size; ++i)
+        for (int y = 0; y < rows; ++y)
+        {
+            double cy = mini + (y0 + y) * stepi;
+            for (int x = 0; x < width; ++x)
             {
-                data[y * width + x + i] = iters[i];
+                chunkR[y * width + x] = minr + x * stepr;
+                chunkI[y * width + x] = cy;
             }
-            
-            processed += current_batch_size;
         }
 
-        if (!speedMode && processed % (width * 10) < BATCH_SIZE)
+        // The kernel runs over the whole chunk so lanes keep flowing across
+        // rows, into a scratch buffer: the output may be on screen, and the
+        // (possibly strided) rows are stored into it once final
+        chunkOut.resize(width * ROWS_PER_CHUNK);
+        evaluate(chunkR.data(), chunkI.data(), chunkOut.data(), rows * width);
+        countChunk(chunkOut.data(), rows * width);
+        for (int y = 0; y < rows; ++y)
+            storeCounts(&at(0, y0 + y), &chunkOut[y * width], width);
+
+        // Update display periodically (skip in speed mode)
+        if (!speedMode && progressCallback)
+            progressCallback();
+    }
+
+    endSeed();
+}
+
+void SimdMandelbrotCalculator::evaluate(const double *cr, const double *ci, IterationCount *values, int count)
+{
+    if (pointKernel)
+        pointKernel(cr, ci, values, count, maxIter);
+    else
+        kernel(cr, ci, values, count, maxIter);
+}
+
+void SimdMandelbrotCalculator::computeUnknown(int y0, int rows)
+{
+    // Seeded frame: only the pixels not reused from the previous frame are
+    // packed for the kernel, then scattered back
+    chunkOut.resize(width * ROWS_PER_CHUNK);
+    chunkIndex.resize(width * ROWS_PER_CHUNK);
+
+    int count = 0;
+    for (int y = 0; y < rows; ++y)
+    {
+        double cy = mini + (y0 + y) * stepi;
+        for (int x = 0; x < width; ++x)
         {
-            if (progressCallback)
-                progressCallback();
+            if (known[(y0 + y) * width + x])
+            {
+                stats.countReused(at(x, y0 + y), maxIter);
+                continue;
+            }
+            chunkR[count] = minr + x * stepr;
+            chunkI[count] = cy;
+            chunkIndex[count] = y * width + x;
+            ++count;
         }
     }
 
+    if (count == 0)
+        return;
+
+    evaluate(chunkR.data(), chunkI.data(), chunkOut.data(), count);
+    countChunk(chunkOut.data(), count);
+    for (int k = 0; k < count; ++k)
+        storeCount(at(chunkIndex[k] % width, y0 + chunkIndex[k] / width), chunkOut[k]);
+}
+
+void SimdMandelbrotCalculator::countChunk(const IterationCount *values, int count)
+{
+    // Still in cache after the kernel wrote it
+    for (int k = 0; k < count; ++k)
+        stats.countIterated(values[k], maxIter);
 }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "storage_mandelbrot_calculator.h"
+#include "simd_kernels.h"
+#include <vector>
 
 class SimdMandelbrotCalculator : public StorageMandelbrotCalculator
 {
@@ -10,4 +12,27 @@ public:
     void compute(std::function<void()> progressCallback) override;
     
     std::string getEngineName() const override { return " simd"; }
+
+    // Lane refill (default): a lane whose pixel escaped takes the next pending
+    // pixel at once, instead of waiting for the slowest pixel of its batch
+    void setLaneRefill(bool enabled);
+    bool getLaneRefill() const { return laneRefill; }
+
+    void setInteriorCheck(bool enabled) override;
+    void setPointKernel(const PointKernel &kernel) override { pointKernel = kernel; }
+
+private:
+    bool laneRefill;
+    SimdKernels::Kernel kernel;
+    PointKernel pointKernel; // Set: used instead of kernel
+
+    // Coordinates of the rows being computed
+    std::vector<double> chunkR;
+    std::vector<double> chunkI;
+    std::vector<IterationCount> chunkOut; // Results of a chunk, before they are stored
+    std::vector<int> chunkIndex;          // Position in the chunk of each packed pixel
+
+    void evaluate(const double *cr, const double *ci, IterationCount *values, int count);
+    void computeUnknown(int y0, int rows);
+    void countChunk(const IterationCount *values, int count);
 };
@@ -1,4 +1,5 @@
 #include "standard_mandelbrot_calculator.h"
+#include "interior_check.h"
 #include <cmath>
 
 StandardMandelbrotCalculator::StandardMandelbrotCalculator(int w, int h)
@@ -8,10 +9,17 @@ StandardMandelbrotCalculator::StandardMandelbrotCalculator(int w, int h)
 
 int StandardMandelbrotCalculator::iterate(double x, double y)
 {
+    if (interiorCheck)
+    {
+        if (inMainCardioidOrBulb(x, y))
+            return maxIter;
+        return iterateWithPeriodicity(x, y, maxIter);
+    }
+
     double r = x, i = y;
     int iter;
 
-    for (iter = 0; iter < MAX_ITER; ++iter)
+    for (iter = 0; iter < maxIter; ++iter)
     {
         double r2 = r * r;
         double i2 = i * i;
@@ -30,14 +38,25 @@ int StandardMandelbrotCalculator::iterate(double x, double y)
 void StandardMandelbrotCalculator::compute(std::function<void()> progressCallback)
 {
     unsigned processed = 0;
-    
-    for (int y = 0; y < height; ++y)
+    const bool skipKnown = !known.empty(); // Pixels reused from the previous frame
+    stats.clear();
+
+    for (int y = 0; y < height && !isCancelled(); ++y)
     {
         double cy = mini + y * stepi;
         for (int x = 0; x < width; ++x)
         {
             double cx = minr + x * stepr;
-            data[y * width + x] = iterate(cx, cy);
+            if (!skipKnown || !known[y * width + x])
+            {
+                int value = iterate(cx, cy);
+                storeCount(at(x, y), value);
+                stats.countIterated(value, maxIter);
+            }
+            else
+            {
+                stats.countReused(at(x, y), maxIter);
+            }
             processed++;
         }
 
@@ -49,4 +68,5 @@ void StandardMandelbrotCalculator::compute(std::function<void()> progressCallbac
         }
     }
 
+    endSeed();
 }
@@ -1,13 +1,88 @@
 #include "storage_mandelbrot_calculator.h"
+#include "frame_snapshot.h"
 #include <algorithm>
 
 StorageMandelbrotCalculator::StorageMandelbrotCalculator(int w, int h)
-    : ZoomMandelbrotCalculator(w, h)
+    : ZoomMandelbrotCalculator(w, h), seeded(false)
 {
     data.resize(width * height, MAX_ITER);
+    out = data.data();
+    pitch = width;
+}
+
+bool StorageMandelbrotCalculator::setOutput(IterationCount *base, int newPitch)
+{
+    if (base)
+    {
+        data.clear();
+        data.shrink_to_fit();
+        out = base;
+        pitch = newPitch;
+    }
+    else
+    {
+        data.assign(width * height, maxIter);
+        out = data.data();
+        pitch = width;
+    }
+    return true;
+}
+
+void StorageMandelbrotCalculator::fillOutput(IterationCount value)
+{
+    for (int y = 0; y < height; ++y)
+        fillCounts(out + y * pitch, width, value);
 }
 
 void StorageMandelbrotCalculator::reset()
 {
-    std::fill(data.begin(), data.end(), MAX_ITER);
+    fillOutput(maxIter);
+}
+
+void StorageMandelbrotCalculator::seed(const FrameSnapshot &previous)
+{
+    endSeed();
+    if (previous.empty())
+        return;
+
+    std::vector<int> columnSource, rowSource;
+    std::vector<unsigned char> columnExact, rowExact;
+    FrameSnapshot::mapAxis(minr, stepr, width, previous.minR, previous.stepR, previous.width, columnSource, columnExact);
+    FrameSnapshot::mapAxis(mini, stepi, height, previous.minI, previous.stepI, previous.height, rowSource, rowExact);
+
+    // Counts from another limit are only good for the preview
+    bool reusable = previous.maxIter == maxIter;
+    bool anyKnown = false;
+    known.assign(width * height, 0);
+
+    for (int y = 0; y < height; ++y)
+    {
+        if (rowSource[y] < 0)
+            continue;
+
+        const IterationCount *src = &previous.data[rowSource[y] * previous.width];
+        for (int x = 0; x < width; ++x)
+        {
+            if (columnSource[x] < 0)
+                continue;
+
+            storeCount(at(x, y), std::min<int>(src[columnSource[x]], maxIter));
+            if (reusable && rowExact[y] && columnExact[x] &&
+                (previous.valid.empty() || previous.valid[rowSource[y] * previous.width + columnSource[x]]))
+            {
+                known[y * width + x] = 1;
+                anyKnown = true;
+            }
+        }
+    }
+
+    if (!anyKnown)
+        known.clear();
+    seeded = true;
+}
+
+void StorageMandelbrotCalculator::endSeed()
+{
+    seeded = false;
+    known.clear();
 }
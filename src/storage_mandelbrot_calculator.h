@@ -8,9 +8,26 @@ class StorageMandelbrotCalculator : public ZoomMandelbrotCalculator
 public:
     StorageMandelbrotCalculator(int width, int height);
 
-    const std::vector<int> &getData() const override { return data; }
+    const std::vector<IterationCount> &getData() const override { return data; }
+    bool setOutput(IterationCount *base, int pitch) override;
     void reset() override;
+    void seed(const FrameSnapshot &previous) override;
 
 protected:
-    std::vector<int> data;
+    // Own pixels, empty while writing to an external output
+    std::vector<IterationCount> data;
+
+    // Where the engines write: pixel (x, y) is out[y * pitch + x]
+    IterationCount *out;
+    int pitch;
+
+    IterationCount &at(int x, int y) { return out[y * pitch + x]; }
+    void fillOutput(IterationCount value);
+
+    // Set by seed() until the end of the next compute(): the output holds a
+    // preview, and known[y * width + x] marks the pixels already final
+    // (empty when there are none)
+    bool seeded;
+    std::vector<unsigned char> known;
+    void endSeed();
 };
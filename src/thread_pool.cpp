@@ -0,0 +1,128 @@
+#include "thread_pool.h"
+#include <algorithm>
+
+// Set on pool workers, and on the caller while it runs a job, so nested
+// parallelFor calls run inline instead of waiting on the busy pool
+static thread_local bool insideJob = false;
+
+ThreadPool::ThreadPool(unsigned numThreads)
+    : job(nullptr), jobCount(0), nextIndex(0), activeWorkers(0), generation(0), stopping(false)
+{
+    workers.reserve(numThreads);
+    for (unsigned t = 0; t < numThreads; ++t)
+    {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+ThreadPool &ThreadPool::instance()
+{
+    // The calling thread also works, so one fewer worker than hardware threads
+    static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return pool;
+}
+
+bool ThreadPool::isInsideJob()
+{
+    return insideJob;
+}
+
+void ThreadPool::runItems()
+{
+    for (;;)
+    {
+        int i = nextIndex.fetch_add(1, std::memory_order_relaxed);
+        if (i >= jobCount)
+            break;
+        (*job)(i);
+    }
+}
+
+void ThreadPool::workerLoop()
+{
+    insideJob = true;
+    unsigned long long seenGeneration = 0;
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeCondition.wait(lock, [this, seenGeneration]()
+                               { return stopping || generation != seenGeneration; });
+            if (stopping)
+                return;
+            seenGeneration = generation;
+        }
+
+        runItems();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--activeWorkers == 0)
+                doneCondition.notify_one();
+        }
+    }
+}
+
+void ThreadPool::parallelFor(int count, const std::function<void(int)> &task)
+{
+    parallelFor(count, task, nullptr);
+}
+
+void ThreadPool::parallelFor(int count, const std::function<void(int)> &task, const std::function<void()> &callerTask)
+{
+    if (count <= 0)
+    {
+        if (callerTask)
+            callerTask();
+        return;
+    }
+
+    // Nothing to share the work with: run inline
+    if (insideJob || workers.empty() || (count == 1 && !callerTask))
+    {
+        if (callerTask)
+            callerTask();
+        for (int i = 0; i < count; ++i)
+            task(i);
+        return;
+    }
+
+    std::lock_guard<std::mutex> jobLock(jobMutex);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &task;
+        jobCount = count;
+        nextIndex.store(0, std::memory_order_relaxed);
+        activeWorkers = static_cast<int>(workers.size());
+        ++generation;
+    }
+    wakeCondition.notify_all();
+
+    insideJob = true;
+    if (callerTask)
+        callerTask();
+    runItems();
+    insideJob = false;
+
+    // Every worker checks in once per job, even if it found no items left
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCondition.wait(lock, [this]()
+                       { return activeWorkers == 0; });
+    job = nullptr;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Long-lived pool of worker threads shared by the multithreaded engines.
+// Workers are created once and sleep between jobs, so per-frame parallel
+// work does not pay thread creation cost.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(unsigned numThreads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // Process-wide pool sized to the hardware concurrency
+    static ThreadPool &instance();
+
+    // Run task(i) for every i in [0, count) and wait for completion.
+    // Indices are handed out one at a time through an atomic counter, so
+    // threads that finish cheap items early keep pulling new ones.
+    // The calling thread takes part in the work. Nested calls made from
+    // inside a task run sequentially on the thread that makes them.
+    void parallelFor(int count, const std::function<void(int)> &task);
+
+    // The same, except that the calling thread first runs callerTask, then
+    // joins in the items left. For work that must stay on the caller (GPU
+    // calls on its GL context) while the workers take the items.
+    void parallelFor(int count, const std::function<void(int)> &task, const std::function<void()> &callerTask);
+
+    // Number of threads working on a job, including the caller
+    unsigned getThreadCount() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+    // True while the current thread runs a task, where a nested parallelFor
+    // would not get any help from the pool
+    static bool isInsideJob();
+
+private:
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::condition_variable doneCondition;
+    std::mutex jobMutex; // Serializes concurrent parallelFor callers
+
+    // Current job, guarded by mutex (the counters are atomic for the work loop)
+    const std::function<void(int)> *job;
+    int jobCount;
+    std::atomic<int> nextIndex;
+    int activeWorkers;
+    unsigned long long generation;
+    bool stopping;
+
+    void workerLoop();
+    void runItems();
+};
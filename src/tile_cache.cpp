@@ -0,0 +1,207 @@
+#include "tile_cache.h"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <format>
+#include <iostream>
+
+bool TileCache::Key::operator==(const Key &other) const
+{
+    return std::bit_cast<uint64_t>(minR) == std::bit_cast<uint64_t>(other.minR) &&
+           std::bit_cast<uint64_t>(minI) == std::bit_cast<uint64_t>(other.minI) &&
+           std::bit_cast<uint64_t>(stepR) == std::bit_cast<uint64_t>(other.stepR) &&
+           std::bit_cast<uint64_t>(stepI) == std::bit_cast<uint64_t>(other.stepI) &&
+           width == other.width && height == other.height && maxIter == other.maxIter && engine == other.engine;
+}
+
+size_t TileCache::KeyHash::operator()(const Key &key) const
+{
+    // FNV-1a over the fields
+    uint64_t hash = 0xcbf29ce484222325ull;
+    auto mix = [&hash](uint64_t value)
+    {
+        for (int k = 0; k < 8; ++k)
+        {
+            hash ^= (value >> (k * 8)) & 0xff;
+            hash *= 0x100000001b3ull;
+        }
+    };
+    mix(std::bit_cast<uint64_t>(key.minR));
+    mix(std::bit_cast<uint64_t>(key.minI));
+    mix(std::bit_cast<uint64_t>(key.stepR));
+    mix(std::bit_cast<uint64_t>(key.stepI));
+    mix((static_cast<uint64_t>(key.width) << 32) | static_cast<uint32_t>(key.height));
+    mix((static_cast<uint64_t>(key.maxIter) << 32) | static_cast<uint32_t>(key.engine));
+    return static_cast<size_t>(hash);
+}
+
+TileCache::~TileCache()
+{
+    // Spilled tiles only make sense to this process
+    clear();
+}
+
+TileCache &TileCache::instance()
+{
+    // Disabled until configured
+    static TileCache cache;
+    return cache;
+}
+
+void TileCache::configure(size_t budget, const std::string &dir)
+{
+    clear();
+    std::lock_guard<std::mutex> lock(mutex);
+    memoryBudget = budget;
+    spillDir = dir;
+}
+
+void TileCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    index.clear();
+    memoryUsed = 0;
+    while (!spilled.empty())
+        dropSpilled(std::prev(spilled.end()));
+}
+
+bool TileCache::lookup(const Key &key, IterationCount *base, int pitch)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!memoryBudget)
+        return false;
+
+    auto found = index.find(key);
+    if (found == index.end())
+    {
+        // Back from the spill directory, as the most recently used tile
+        std::vector<IterationCount> data;
+        if (!unspill(key, data))
+            return false;
+        insert(Entry{key, std::move(data)});
+        found = index.find(key);
+        if (found == index.end())
+            return false; // Larger than the whole budget
+    }
+
+    // Most recently used first
+    entries.splice(entries.begin(), entries, found->second);
+    const std::vector<IterationCount> &data = found->second->data;
+    for (int y = 0; y < key.height; ++y)
+        storeCounts(base + static_cast<size_t>(y) * pitch, &data[static_cast<size_t>(y) * key.width], key.width);
+    return true;
+}
+
+void TileCache::store(const Key &key, const IterationCount *base, int pitch)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!memoryBudget || index.count(key))
+        return;
+
+    Entry entry{key, std::vector<IterationCount>(static_cast<size_t>(key.width) * key.height)};
+    for (int y = 0; y < key.height; ++y)
+        std::copy_n(base + static_cast<size_t>(y) * pitch, key.width, &entry.data[static_cast<size_t>(y) * key.width]);
+    insert(std::move(entry));
+}
+
+void TileCache::insert(Entry entry)
+{
+    // Called with the mutex held
+    size_t bytes = bytesOf(entry.key);
+    if (bytes > memoryBudget)
+        return;
+
+    // Evict the least recently used tiles to make room
+    while (memoryUsed + bytes > memoryBudget && !entries.empty())
+    {
+        Entry &oldest = entries.back();
+        if (!spillDir.empty())
+            spill(oldest);
+        memoryUsed -= bytesOf(oldest.key);
+        index.erase(oldest.key);
+        entries.pop_back();
+    }
+
+    Key key = entry.key;
+    entries.push_front(std::move(entry));
+    index[key] = entries.begin();
+    memoryUsed += bytes;
+}
+
+std::string TileCache::spillPath(const Key &key) const
+{
+    return std::format("{}/tile-{:016x}.bin", spillDir, static_cast<uint64_t>(KeyHash()(key)));
+}
+
+void TileCache::spill(const Entry &entry)
+{
+    // Called with the mutex held. A file is the key, then the counts; a
+    // tile whose hash collides with a spilled one replaces it.
+    auto existing = spillIndex.find(entry.key);
+    if (existing != spillIndex.end())
+        return;
+    for (auto it = spilled.begin(); it != spilled.end(); ++it)
+    {
+        if (KeyHash()(*it) == KeyHash()(entry.key))
+        {
+            dropSpilled(it);
+            break;
+        }
+    }
+
+    size_t bytes = bytesOf(entry.key);
+    while (spillUsed + bytes > memoryBudget * SPILL_FACTOR && !spilled.empty())
+        dropSpilled(std::prev(spilled.end()));
+
+    std::string path = spillPath(entry.key);
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        std::cerr << "Tile cache: cannot write " << path << std::endl;
+        return;
+    }
+    bool written = fwrite(&entry.key, sizeof(Key), 1, file) == 1 &&
+                   fwrite(entry.data.data(), sizeof(IterationCount), entry.data.size(), file) == entry.data.size();
+    if (fclose(file) != 0 || !written)
+    {
+        std::cerr << "Tile cache: cannot write " << path << std::endl;
+        std::remove(path.c_str());
+        return;
+    }
+
+    spilled.push_front(entry.key);
+    spillIndex[entry.key] = spilled.begin();
+    spillUsed += bytes;
+}
+
+bool TileCache::unspill(const Key &key, std::vector<IterationCount> &data)
+{
+    // Called with the mutex held. The tile leaves the directory: it is back
+    // in memory, and spilled again if it gets evicted again.
+    auto found = spillIndex.find(key);
+    if (found == spillIndex.end())
+        return false;
+
+    std::string path = spillPath(key);
+    FILE *file = fopen(path.c_str(), "rb");
+    Key stored;
+    data.resize(static_cast<size_t>(key.width) * key.height);
+    bool read = file && fread(&stored, sizeof(Key), 1, file) == 1 && stored == key &&
+                fread(data.data(), sizeof(IterationCount), data.size(), file) == data.size();
+    if (file)
+        fclose(file);
+
+    dropSpilled(found->second);
+    return read;
+}
+
+void TileCache::dropSpilled(std::list<Key>::iterator it)
+{
+    // Called with the mutex held
+    std::remove(spillPath(*it).c_str());
+    spillUsed -= bytesOf(*it);
+    spillIndex.erase(*it);
+    spilled.erase(it);
+}
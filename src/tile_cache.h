@@ -0,0 +1,82 @@
+#pragma once
+
+#include "mandelbrot_calculator.h"
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Iteration counts of computed tiles, so that views which come back (the
+// home view after an auto-zoom reset, zooming out and in again) are copied
+// instead of recomputed. A tile is identified by its exact samples: the bit
+// patterns of its origin and pixel step, its size, the iteration limit and
+// the engine. The least recently used tiles are evicted past the memory
+// budget; with a spill directory they are written there instead of being
+// dropped (up to SPILL_FACTOR times the budget) and read back on a hit.
+// Process-wide and thread safe, as the grid tiles are computed in parallel.
+class TileCache
+{
+public:
+    struct Key
+    {
+        double minR, minI;
+        double stepR, stepI;
+        int width, height;
+        int maxIter;
+        int engine;
+
+        bool operator==(const Key &other) const; // Bitwise on the doubles
+    };
+
+    static constexpr size_t DEFAULT_BUDGET = 256u << 20;
+    static constexpr size_t SPILL_FACTOR = 4;
+
+    ~TileCache();
+
+    static TileCache &instance();
+
+    // Memory budget in bytes (0 disables the cache) and the directory for
+    // evicted tiles (empty: they are dropped). Clears the cache.
+    void configure(size_t memoryBudget, const std::string &spillDir);
+    bool isEnabled() const { return memoryBudget > 0; }
+
+    // Copies a cached tile to base (pixel (x, y) at base[y * pitch + x]).
+    // False, and base untouched, if the tile is not cached.
+    bool lookup(const Key &key, IterationCount *base, int pitch);
+    void store(const Key &key, const IterationCount *base, int pitch);
+
+    void clear();
+
+private:
+    struct KeyHash
+    {
+        size_t operator()(const Key &key) const;
+    };
+
+    struct Entry
+    {
+        Key key;
+        std::vector<IterationCount> data; // width * height, packed rows
+    };
+
+    std::mutex mutex;
+    size_t memoryBudget = 0;
+    size_t memoryUsed = 0;
+    std::list<Entry> entries; // Most recently used first
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+
+    // Spilled tiles, one file each, most recently spilled first
+    std::string spillDir;
+    size_t spillUsed = 0;
+    std::list<Key> spilled;
+    std::unordered_map<Key, std::list<Key>::iterator, KeyHash> spillIndex;
+
+    static size_t bytesOf(const Key &key) { return static_cast<size_t>(key.width) * key.height * sizeof(IterationCount); }
+    std::string spillPath(const Key &key) const;
+    void insert(Entry entry);
+    void spill(const Entry &entry);
+    bool unspill(const Key &key, std::vector<IterationCount> &data);
+    void dropSpilled(std::list<Key>::iterator it);
+};
@@ -2,12 +2,17 @@
 #include <algorithm>
 
 ZoomMandelbrotCalculator::ZoomMandelbrotCalculator(int w, int h)
-    : width(w), height(h), speedMode(false)
+    : width(w), height(h), speedMode(false), interiorCheck(true), maxIter(MAX_ITER), cancelFlag(nullptr)
 {
     // Default initialization
     updateBounds(-0.5, 0.0, 3.0);
 }
 
+void ZoomMandelbrotCalculator::setMaxIterations(int newMaxIter)
+{
+    maxIter = std::clamp(newMaxIter, 1, MAX_ITER_LIMIT);
+}
+
 void ZoomMandelbrotCalculator::updateBounds(double new_cre, double new_cim, double new_diam)
 {
     cre = new_cre;
@@ -24,6 +24,16 @@ public:
     void setSpeedMode(bool mode) override { speedMode = mode; }
     bool getSpeedMode() const override { return speedMode; }
 
+    void setInteriorCheck(bool enabled) override { interiorCheck = enabled; }
+    bool getInteriorCheck() const override { return interiorCheck; }
+
+    void setMaxIterations(int maxIter) override;
+    int getMaxIterations() const override { return maxIter; }
+
+    void setCancelFlag(const std::atomic<bool> *flag) override { cancelFlag = flag; }
+
+    const CalculatorStats &getStats() const override { return stats; }
+
 protected:
     int width;
     int height;
@@ -33,4 +43,13 @@ protected:
     double stepr, stepi;
 
     bool speedMode;
+    bool interiorCheck;
+    int maxIter;
+
+    const std::atomic<bool> *cancelFlag;
+    bool isCancelled() const { return cancelFlag && cancelFlag->load(std::memory_order_relaxed); }
+
+    // Cleared and filled by compute() (the GPU engine completes it when
+    // its results are read)
+    mutable CalculatorStats stats;
 };
@@ -1,4 +1,5 @@
 #include "zoom_point_chooser.h"
+#include "thread_pool.h"
 #include <algorithm>
 #include <cstdlib>
 
@@ -7,74 +8,148 @@ ZoomPointChooser::ZoomPointChooser(int w, int h)
 {
 }
 
-void ZoomPointChooser::getIterationRange(const std::vector<int> &data, int maxIter,
-                                         int x, int y, int w, int h,
-                                         int &outMin, int &outMax)
+namespace
 {
-    outMin = maxIter;
-    outMax = 0;
+    // Lines (rows or columns) handled together as the lanes of one pass:
+    // the column pass walks a cache line of counts per row instead of going
+    // down a single column
+    const int LINE_BLOCK = 32;
 
-    // Clamp rectangle to screen bounds
-    int x1 = std::max(0, x);
-    int y1 = std::max(0, y);
-    int x2 = std::min(width, x + w);
-    int y2 = std::min(height, y + h);
+    // Scratch lines of a slideWindow call, reused by the next one
+    struct WindowBuffers
+    {
+        std::vector<IterationCount> line, prefix, suffix;
+    };
 
-    for (int py = y1; py < y2; ++py)
+    // Sliding window extreme (van Herk / Gil-Werman), for `lanes`
+    // independent lines of n values at once: out(i, lane) gets the extreme
+    // (op = min or max) of value(j, lane) for j in [i - w / 2, i - w / 2 + w)
+    // clamped to the line. The line is padded with the neutral value so every
+    // window has w values, and cut in blocks of w: a window is then the end of
+    // one block and the start of the next, read from the suffix and prefix
+    // extremes. Three ops per value, without branches on the data.
+    template <typename Value, typename Op, typename Out>
+    void slideWindow(int n, int lanes, int w, IterationCount neutral, Value value, Op op, Out out, WindowBuffers &buffers)
     {
-        for (int px = x1; px < x2; ++px)
+        const int left = w / 2;
+        const int padded = n + w - 1;
+        const size_t size = static_cast<size_t>(padded) * lanes;
+        buffers.line.assign(size, neutral);
+        buffers.prefix.resize(size);
+        buffers.suffix.resize(size);
+        IterationCount *in = buffers.line.data();
+        IterationCount *g = buffers.prefix.data();
+        IterationCount *h = buffers.suffix.data();
+
+        for (int i = 0; i < n; ++i)
         {
-            int p = py * width + px;
-            int iter = data[p];
+            for (int lane = 0; lane < lanes; ++lane)
+                in[static_cast<size_t>(i + left) * lanes + lane] = value(i, lane);
+        }
 
-            if (iter < maxIter)
-            {
-                if (iter < outMin)
-                    outMin = iter;
-                if (iter > outMax)
-                    outMax = iter;
-            }
+        for (int b = 0; b < padded; b += w)
+        {
+            const int e = std::min(b + w, padded);
+            for (int lane = 0; lane < lanes; ++lane)
+                g[static_cast<size_t>(b) * lanes + lane] = in[static_cast<size_t>(b) * lanes + lane];
+            for (size_t k = static_cast<size_t>(b + 1) * lanes; k < static_cast<size_t>(e) * lanes; ++k)
+                g[k] = op(g[k - lanes], in[k]);
+
+            for (int lane = 0; lane < lanes; ++lane)
+                h[static_cast<size_t>(e - 1) * lanes + lane] = in[static_cast<size_t>(e - 1) * lanes + lane];
+            for (size_t k = static_cast<size_t>(e - 1) * lanes; k-- > static_cast<size_t>(b) * lanes;)
+                h[k] = op(h[k + lanes], in[k]);
+        }
+
+        // Window of i: padded [i, i + w)
+        for (int i = 0; i < n; ++i)
+        {
+            const IterationCount *hi = &h[static_cast<size_t>(i) * lanes];
+            const IterationCount *gi = &g[static_cast<size_t>(i + w - 1) * lanes];
+            for (int lane = 0; lane < lanes; ++lane)
+                out(i, lane, op(hi[lane], gi[lane]));
         }
     }
+
+    IterationCount lower(IterationCount a, IterationCount b) { return std::min(a, b); }
+    IterationCount higher(IterationCount a, IterationCount b) { return std::max(a, b); }
 }
 
-int ZoomPointChooser::calculateDiversityScore(const std::vector<int> &data, int maxIter,
-                                              int centerX, int centerY,
-                                              int rectWidth, int rectHeight)
+int ZoomPointChooser::buildWindowRanges(const IterationCount *data, int maxIter,
+                                        int rectWidth, int rectHeight)
 {
-    int x = centerX - rectWidth / 2;
-    int y = centerY - rectHeight / 2;
+    const size_t pixels = static_cast<size_t>(width) * height;
+    windowMin.resize(pixels);
+    windowMax.resize(pixels);
+
+    const int w = std::max(1, rectWidth);
+    const int h = std::max(1, rectHeight);
+    const IterationCount none = static_cast<IterationCount>(maxIter);
+
+    // Rows: the range of each horizontal window, blocks of rows as the lanes
+    // (transposed into the padded line) so both passes vectorize
+    const int rowBlocks = (height + LINE_BLOCK - 1) / LINE_BLOCK;
+    ThreadPool::instance().parallelFor(rowBlocks, [&](int block)
+    {
+        const int y0 = block * LINE_BLOCK;
+        const int rows = std::min(LINE_BLOCK, height - y0);
+        const IterationCount *in = &data[static_cast<size_t>(y0) * width];
+        IterationCount *outMin = &windowMin[static_cast<size_t>(y0) * width];
+        IterationCount *outMax = &windowMax[static_cast<size_t>(y0) * width];
+        WindowBuffers buffers;
+        slideWindow(width, rows, w, none,
+                    [&](int x, int r) { IterationCount v = in[static_cast<size_t>(r) * width + x]; return v < maxIter ? v : none; },
+                    lower, [&](int x, int r, IterationCount v) { outMin[static_cast<size_t>(r) * width + x] = v; }, buffers);
+        slideWindow(width, rows, w, 0,
+                    [&](int x, int r) { IterationCount v = in[static_cast<size_t>(r) * width + x]; return v < maxIter ? v : IterationCount(0); },
+                    higher, [&](int x, int r, IterationCount v) { outMax[static_cast<size_t>(r) * width + x] = v; }, buffers);
+    });
 
-    int minIter, maxIter_;
-    getIterationRange(data, maxIter, x, y, rectWidth, rectHeight, minIter, maxIter_);
+    // Columns, in place: the whole block is copied to the padded line
+    // before any of it is written
+    const int columnBlocks = (width + LINE_BLOCK - 1) / LINE_BLOCK;
+    ThreadPool::instance().parallelFor(columnBlocks, [&](int block)
+    {
+        const int x0 = block * LINE_BLOCK;
+        const int columns = std::min(LINE_BLOCK, width - x0);
+        WindowBuffers buffers;
+        for (std::vector<IterationCount> *range : {&windowMin, &windowMax})
+        {
+            IterationCount *base = range->data() + x0;
+            auto value = [&](int y, int c) { return base[static_cast<size_t>(y) * width + c]; };
+            auto out = [&](int y, int c, IterationCount v) { base[static_cast<size_t>(y) * width + c] = v; };
+            if (range == &windowMin)
+                slideWindow(height, columns, h, none, value, lower, out, buffers);
+            else
+                slideWindow(height, columns, h, 0, value, higher, out, buffers);
+        }
+    });
+
+    // The peak is the max of the windows, which each cover at least one pixel
+    return pixels ? *std::max_element(windowMax.begin(), windowMax.end()) : 0;
+}
+
+int64_t ZoomPointChooser::calculateDiversityScore(int centerX, int centerY) const
+{
+    size_t p = static_cast<size_t>(centerY) * width + centerX;
+    int minIter = windowMin[p];
+    int maxIter_ = windowMax[p];
 
     // Score is based on:
     // 1. Range of iterations (diversity)
     // 2. Maximum iteration value (we want high complexity)
-    // Combined score: range * maxIter
-    int range = maxIter_ - minIter;
+    // Combined score: range * maxIter (up to ~2^32 at the highest limit)
+    int64_t range = maxIter_ - minIter;
     return range * maxIter_;
 }
 
-bool ZoomPointChooser::findInterestingPoint(const std::vector<int> &data, int maxIter,
+bool ZoomPointChooser::findInterestingPoint(const IterationCount *data, int maxIter,
                                             int &outX, int &outY,
                                             int zoomRectWidth, int zoomRectHeight)
 {
-    // First pass: find the maximum non-MAX_ITER value in the entire view
-    int maxIterFound = 0;
-    for (int y = 0; y < height; ++y)
-    {
-        for (int x = 0; x < width; ++x)
-        {
-            int p = y * width + x;
-            int iter = data[p];
-
-            if (iter < maxIter && iter > maxIterFound)
-            {
-                maxIterFound = iter;
-            }
-        }
-    }
+    // First pass: the iteration range around every pixel, and the maximum
+    // non-MAX_ITER value in the entire view
+    int maxIterFound = buildWindowRanges(data, maxIter, zoomRectWidth, zoomRectHeight);
 
     // If we found no valid iterations, fall back to center
     if (maxIterFound == 0)
@@ -87,14 +162,14 @@ bool ZoomPointChooser::findInterestingPoint(const std::vector<int> &data, int ma
     // Define candidates as points with high iteration values
     int threshold = maxIterFound - 5;
 
-    // Second pass: use reservoir sampling to pick up to 100 candidate points
+    // Second pass: use reservoir sampling to pick up to MAX_CANDIDATES points
     // This limits scoring to a fixed number regardless of how many pixels qualify
     struct Point
     {
         int x, y;
     };
     std::vector<Point> sampledPoints;
-    sampledPoints.reserve(100);
+    sampledPoints.reserve(MAX_CANDIDATES);
     
     int count = 0;
     for (int y = 0; y < height; ++y)
@@ -108,7 +183,7 @@ bool ZoomPointChooser::findInterestingPoint(const std::vector<int> &data, int ma
             if (iter >= threshold && iter < maxIter)
             {
                 count++;
-                if (sampledPoints.size() < 100)
+                if (sampledPoints.size() < MAX_CANDIDATES)
                 {
                     // Fill reservoir
                     sampledPoints.push_back({x, y});
@@ -117,7 +192,7 @@ bool ZoomPointChooser::findInterestingPoint(const std::vector<int> &data, int ma
                 {
                     // Randomly replace with decreasing probability
                     int j = rand() % count;
-                    if (j < 100)
+                    if (j < MAX_CANDIDATES)
                     {
                         sampledPoints[j] = {x, y};
                     }
@@ -134,21 +209,31 @@ bool ZoomPointChooser::findInterestingPoint(const std::vector<int> &data, int ma
         return false;
     }
 
-    // Score the sampled points
+    // Score the sampled points, in chunks on the thread pool
     struct Candidate
     {
         int x, y;
-        int score;
+        int64_t score;
     };
+    std::vector<Candidate> scored(sampledPoints.size());
+    const int chunk = 256;
+    const int chunks = static_cast<int>((sampledPoints.size() + chunk - 1) / chunk);
+    ThreadPool::instance().parallelFor(chunks, [&](int c)
+    {
+        size_t end = std::min(sampledPoints.size(), static_cast<size_t>(c + 1) * chunk);
+        for (size_t i = static_cast<size_t>(c) * chunk; i < end; ++i)
+        {
+            const auto &point = sampledPoints[i];
+            scored[i] = {point.x, point.y, calculateDiversityScore(point.x, point.y)};
+        }
+    });
+
     std::vector<Candidate> candidates;
-    
-    for (const auto& point : sampledPoints)
+    for (const auto &candidate : scored)
     {
-        int score = calculateDiversityScore(data, maxIter, point.x, point.y,
-                                            zoomRectWidth, zoomRectHeight);
-        if (score > 0)
+        if (candidate.score > 0)
         {
-            candidates.push_back({point.x, point.y, score});
+            candidates.push_back(candidate);
         }
     }
 
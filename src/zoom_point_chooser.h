@@ -1,5 +1,7 @@
 #pragma once
 
+#include "mandelbrot_calculator.h"
+#include <cstdint>
 #include <vector>
 
 class ZoomPointChooser
@@ -9,21 +11,30 @@ public:
 
     // Find an interesting point to zoom to
     // Returns true if a good point was found, false if falling back to center
-    bool findInterestingPoint(const std::vector<int> &data, int maxIter,
+    // data: width * height counts, rows top to bottom
+    bool findInterestingPoint(const IterationCount *data, int maxIter,
                               int &outX, int &outY,
                               int zoomRectWidth, int zoomRectHeight);
 
 private:
+    // Candidates kept by the reservoir sampling and scored
+    static constexpr int MAX_CANDIDATES = 4096;
+
     int width;
     int height;
 
-    // Helper to calculate min/max iterations in a rectangle
-    void getIterationRange(const std::vector<int> &data, int maxIter,
-                           int x, int y, int w, int h,
-                           int &outMin, int &outMax);
+    // Min and max escaped iteration count of the zoomRectWidth x
+    // zoomRectHeight window centered on each pixel (clamped to the frame),
+    // built once per frame so each candidate is scored in O(1). Pixels that
+    // did not escape count as maxIter for the min and 0 for the max.
+    std::vector<IterationCount> windowMin;
+    std::vector<IterationCount> windowMax;
+
+    // Fills windowMin/windowMax with sliding window passes, rows then
+    // columns, on the thread pool. Returns the max escaped count in the frame.
+    int buildWindowRanges(const IterationCount *data, int maxIter,
+                          int rectWidth, int rectHeight);
 
     // Calculate diversity score for a potential zoom point
-    int calculateDiversityScore(const std::vector<int> &data, int maxIter,
-                                int centerX, int centerY,
-                                int rectWidth, int rectHeight);
+    int64_t calculateDiversityScore(int centerX, int centerY) const;
 };